@@ -45,6 +45,8 @@ public:
   }
 
 private:
+  friend class EspgotchiBench; // banc de mesure (src/bench) : readStablePress()
+
   uint16_t lastX = 0;
   uint16_t lastY = 0;
   bool lastDown = false;
@@ -0,0 +1,192 @@
+#include "InputRecorder.h"
+
+static constexpr uint32_t HEADER_SIZE = 24;
+static constexpr uint32_t EVENT_SIZE = 9;
+
+static void putU16(uint8_t *&p, uint16_t v)
+{
+  *p++ = (uint8_t)v;
+  *p++ = (uint8_t)(v >> 8);
+}
+
+static void putU32(uint8_t *&p, uint32_t v)
+{
+  for (int i = 0; i < 4; i++)
+    *p++ = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t getU16(const uint8_t *&p)
+{
+  const uint16_t v = (uint16_t)(p[0] | (p[1] << 8));
+  p += 2;
+  return v;
+}
+
+static uint32_t getU32(const uint8_t *&p)
+{
+  const uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  p += 4;
+  return v;
+}
+
+void InputRecorder::begin(InputEvent *events, uint16_t maxEvents)
+{
+  _events = (events && maxEvents) ? events : nullptr;
+  _maxEvents = _events ? maxEvents : 0;
+  _count = 0;
+  _snapLen = 0;
+  _mode = Mode::IDLE;
+}
+
+void InputRecorder::startRecording(const uint8_t *snap, uint16_t len, uint32_t tick, uint8_t engine)
+{
+  if (!_events || len == 0 || len > sizeof(_snap))
+    return;
+
+  memcpy(_snap, snap, len);
+  _snapLen = len;
+  _engine = engine;
+  _startTick = tick;
+  _endTick = tick;
+  _endHash = 0;
+  _count = 0;
+  _lastButtons = 0;
+  _mode = Mode::RECORDING;
+}
+
+bool InputRecorder::record(uint32_t tick, uint8_t buttons, uint32_t hash)
+{
+  if (_mode != Mode::RECORDING || buttons == _lastButtons)
+    return true;
+  if (_count >= _maxEvents)
+    return false;
+
+  _events[_count++] = {tick, hash, buttons};
+  _lastButtons = buttons;
+  return true;
+}
+
+void InputRecorder::stopRecording(uint32_t tick, uint32_t hash)
+{
+  if (_mode != Mode::RECORDING)
+    return;
+
+  _endTick = tick;
+  _endHash = hash;
+  _mode = Mode::IDLE;
+}
+
+void InputRecorder::startReplay()
+{
+  if (!hasRecording())
+    return;
+
+  _next = 0;
+  _stats = {};
+  _stats.events = _count;
+  _mode = Mode::REPLAYING;
+}
+
+uint32_t InputRecorder::ticksToNext(uint32_t now) const
+{
+  const uint32_t due = (_next < _count) ? _events[_next].tick : _endTick;
+  return ((int32_t)(due - now) > 0) ? due - now : 0;
+}
+
+const InputEvent *InputRecorder::advance(uint32_t now, uint32_t hash)
+{
+  if (_mode != Mode::REPLAYING)
+    return nullptr;
+
+  if (_next < _count)
+  {
+    const InputEvent *ev = &_events[_next++];
+    _stats.applied++;
+    if (now != ev->tick)
+      _stats.late++;
+    if (hash != ev->hash)
+      _stats.hashMismatches++;
+    return ev;
+  }
+
+  if (now != _endTick)
+    _stats.late++;
+  _stats.endHashOk = (hash == _endHash);
+  _mode = Mode::IDLE;
+  return nullptr;
+}
+
+uint32_t InputRecorder::serializedSize() const
+{
+  return HEADER_SIZE + _snapLen + (uint32_t)_count * EVENT_SIZE + 4;
+}
+
+uint32_t InputRecorder::serialize(uint8_t *out, uint32_t cap) const
+{
+  const uint32_t size = serializedSize();
+  if (!hasRecording() || cap < size)
+    return 0;
+
+  uint8_t *p = out;
+  memcpy(p, "EGIR", 4);
+  p += 4;
+  putU16(p, VERSION);
+  *p++ = _engine;
+  *p++ = 0;
+  putU32(p, _startTick);
+  putU32(p, _endTick);
+  putU32(p, _endHash);
+  putU16(p, _snapLen);
+  putU16(p, _count);
+  memcpy(p, _snap, _snapLen);
+  p += _snapLen;
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    putU32(p, _events[i].tick);
+    putU32(p, _events[i].hash);
+    *p++ = _events[i].buttons;
+  }
+  putU32(p, espgotchi_savestate_crc32(0, out, (u32_t)(p - out)));
+  return size;
+}
+
+bool InputRecorder::deserialize(const uint8_t *in, uint32_t len)
+{
+  if (!_events || len < HEADER_SIZE + 4 || memcmp(in, "EGIR", 4) != 0)
+    return false;
+
+  const uint8_t *p = in + 4;
+  if (getU16(p) != VERSION)
+    return false;
+  const uint8_t engine = *p++;
+  p++;
+  const uint32_t startTick = getU32(p);
+  const uint32_t endTick = getU32(p);
+  const uint32_t endHash = getU32(p);
+  const uint16_t snapLen = getU16(p);
+  const uint16_t count = getU16(p);
+
+  const uint32_t body = HEADER_SIZE + snapLen + (uint32_t)count * EVENT_SIZE;
+  if (snapLen == 0 || snapLen > sizeof(_snap) || count > _maxEvents || len < body + 4)
+    return false;
+  const uint8_t *crcAt = in + body;
+  if (getU32(crcAt) != espgotchi_savestate_crc32(0, in, body))
+    return false;
+
+  _mode = Mode::IDLE;
+  _engine = engine;
+  _startTick = startTick;
+  _endTick = endTick;
+  _endHash = endHash;
+  memcpy(_snap, p, snapLen);
+  _snapLen = snapLen;
+  p += snapLen;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    _events[i].tick = getU32(p);
+    _events[i].hash = getU32(p);
+    _events[i].buttons = *p++;
+  }
+  _count = count;
+  return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Arduino.h>
+
+extern "C"
+{
+#include "arduinogotchi_core/espgotchi_savestate.h"
+}
+
+// Transition des boutons Tama, datée en temps émulé
+struct InputEvent
+{
+  uint32_t tick;   // tick_counter au moment de la transition
+  uint32_t hash;   // empreinte de l'écran LCD (matrice + icônes) à cet instant
+  uint8_t buttons; // nouvel état (bits BTN_LEFT / BTN_MIDDLE / BTN_RIGHT)
+};
+
+struct InputReplayStats
+{
+  uint16_t events;         // événements de l'enregistrement
+  uint16_t applied;        // événements rejoués
+  uint16_t late;           // échéances dépassées (désynchronisation)
+  uint16_t hashMismatches; // écran différent de l'enregistrement
+  bool endHashOk;          // écran identique à la fin de l'enregistrement
+};
+
+// Journal d'entrées déterministe : instantané de départ + transitions des
+// boutons datées en tick_counter. Le rejeu repart de l'instantané et
+// réapplique chaque transition au même tick, quel que soit le débit réel
+// (x1..x8 ou MAX) ; l'empreinte LCD notée à chaque transition et à la fin
+// sert de contrôle de non-régression.
+//
+// Format sérialisé (petit-boutiste) :
+//   "EGIR" | version u16 | moteur u8 | 0 | tick début u32 | tick fin u32 |
+//   empreinte fin u32 | taille instantané u16 | événements u16 |
+//   instantané | événements (tick u32, empreinte u32, boutons u8) | CRC32
+class InputRecorder
+{
+public:
+  enum class Mode : uint8_t
+  {
+    IDLE,
+    RECORDING,
+    REPLAYING,
+  };
+
+  static constexpr uint16_t VERSION = 1;
+
+  // events alloué par l'appelant (TamaHost : hal_malloc, au premier usage)
+  void begin(InputEvent *events, uint16_t maxEvents);
+  bool enabled() const { return _events != nullptr; }
+
+  Mode mode() const { return _mode; }
+  bool recording() const { return _mode == Mode::RECORDING; }
+  bool replaying() const { return _mode == Mode::REPLAYING; }
+  bool hasRecording() const { return _snapLen != 0 && _mode != Mode::RECORDING; }
+
+  // --- Enregistrement ---
+  void startRecording(const uint8_t *snap, uint16_t len, uint32_t tick, uint8_t engine);
+  // false : journal plein, l'événement n'est pas retenu
+  bool record(uint32_t tick, uint8_t buttons, uint32_t hash);
+  void stopRecording(uint32_t tick, uint32_t hash);
+  uint8_t lastButtons() const { return _lastButtons; }
+
+  // --- Rejeu ---
+  const uint8_t *snapshot() const { return _snap; }
+  uint16_t snapshotLen() const { return _snapLen; }
+  uint8_t engine() const { return _engine; }
+  uint16_t eventCount() const { return _count; }
+  uint32_t spanTicks() const { return _endTick - _startTick; }
+
+  void startReplay();
+  // Ticks avant la prochaine échéance (transition ou fin), 0 si atteinte
+  uint32_t ticksToNext(uint32_t now) const;
+  // Échéance atteinte : contrôle tick + empreinte, retourne la transition à
+  // appliquer, ou nullptr en fin d'enregistrement (rejeu terminé)
+  const InputEvent *advance(uint32_t now, uint32_t hash);
+  void abortReplay() { _mode = Mode::IDLE; }
+  const InputReplayStats &replayStats() const { return _stats; }
+
+  // --- Sérialisation (fichier natif, dump série) ---
+  uint32_t serializedSize() const;
+  uint32_t serialize(uint8_t *out, uint32_t cap) const;
+  bool deserialize(const uint8_t *in, uint32_t len);
+
+private:
+  InputEvent *_events = nullptr;
+  uint16_t _maxEvents = 0;
+  uint16_t _count = 0;
+  uint16_t _next = 0;
+
+  Mode _mode = Mode::IDLE;
+  uint8_t _engine = 0;
+  uint8_t _lastButtons = 0;
+  uint32_t _startTick = 0;
+  uint32_t _endTick = 0;
+  uint32_t _endHash = 0;
+
+  uint8_t _snap[ESPGOTCHI_SAVESTATE_MAX_SIZE];
+  uint16_t _snapLen = 0;
+
+  InputReplayStats _stats = {};
+};
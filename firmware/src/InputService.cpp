@@ -1,5 +1,8 @@
 #include "InputService.h"
 
+// Durée d'appui sur la barre d'icônes déclenchant un REWIND
+static constexpr uint32_t REWIND_HOLD_MS = 1500;
+
 void InputService::begin()
 {
   input.begin();
@@ -14,6 +17,13 @@ void InputService::begin()
 
 void InputService::update()
 {
+  apply(sample());
+}
+
+InputSample InputService::sample()
+{
+  InputSample in = {0, 0, LogicalButton::NONE};
+
   // 1) Met à jour l'état tactile / boutons virtuels
   input.update();
 
@@ -34,7 +44,7 @@ void InputService::update()
           y < SPEED_BTN_Y + SPEED_BTN_H)
       {
 
-        _tapPending[static_cast<uint8_t>(LogicalButton::SPEED)] = true;
+        in.taps |= 1u << static_cast<uint8_t>(LogicalButton::SPEED);
       }
 
       // --- Bouton DEBUG "invisible" : zone centrale de l'écran ---
@@ -47,40 +57,77 @@ void InputService::update()
           y >= centerTop && y < centerBottom)
       {
 
-        _tapPending[static_cast<uint8_t>(LogicalButton::DEBUG_CENTER)] = true;
+        in.taps |= 1u << static_cast<uint8_t>(LogicalButton::DEBUG_CENTER);
       }
+
+      // --- Barre d'icônes (hors SPD) : candidat à l'appui long REWIND ---
+      _pressStartMs = millis();
+      _pressInTopbar = (y < TOP_BAR_H && x < SPEED_BTN_X);
+      _longPressFired = false;
+    }
+
+    if (ok && bDown && _pressInTopbar && !_longPressFired &&
+        millis() - _pressStartMs >= REWIND_HOLD_MS)
+    {
+      _longPressFired = true;
+      in.taps |= 1u << static_cast<uint8_t>(LogicalButton::REWIND);
     }
 
     _lastTouchDown = bDown;
   }
 
-  // 2) Mappe l'état "held" vers les boutons TamaLib (hw_set_button)
-  VButton heldV = input.peekHeld();
-
-  // Par défaut tout relâché
-  hw_set_button(BTN_LEFT, BTN_STATE_RELEASED);
-  hw_set_button(BTN_MIDDLE, BTN_STATE_RELEASED);
-  hw_set_button(BTN_RIGHT, BTN_STATE_RELEASED);
-
-  switch (heldV)
+  // 2) Mappe l'état "held" vers les boutons TamaLib
+  uint8_t mask = 0;
+  switch (input.peekHeld())
   {
   case VButton::LEFT:
-    hw_set_button(BTN_LEFT, BTN_STATE_PRESSED);
+    mask = 1u << BTN_LEFT;
     break;
   case VButton::OK:
-    hw_set_button(BTN_MIDDLE, BTN_STATE_PRESSED);
+    mask = 1u << BTN_MIDDLE;
     break;
   case VButton::RIGHT:
-    hw_set_button(BTN_RIGHT, BTN_STATE_PRESSED);
+    mask = 1u << BTN_RIGHT;
     break;
   case VButton::LR:
-    hw_set_button(BTN_LEFT, BTN_STATE_PRESSED);
-    hw_set_button(BTN_RIGHT, BTN_STATE_PRESSED);
+    mask = (1u << BTN_LEFT) | (1u << BTN_RIGHT);
     break;
   default:
     // NONE -> aucun bouton pressé
     break;
   }
+  in.buttons = mask;
+  in.held = getHeld();
+  return in;
+}
+
+void InputService::apply(const InputSample &in)
+{
+  const uint8_t kCount = sizeof(_tapPending) / sizeof(_tapPending[0]);
+  for (uint8_t i = 0; i < kCount; i++)
+  {
+    if (in.taps & (1u << i))
+      _tapPending[i] = true;
+  }
+
+  // hw_set_button() : le rejeu d'entrées pilote seul les boutons Tama
+  if (_liveButtons)
+    setButtons(in.buttons);
+}
+
+void InputService::setButtons(uint8_t mask)
+{
+  static const button_t kButtons[] = {BTN_LEFT, BTN_MIDDLE, BTN_RIGHT};
+
+  // hw_set_button(PRESSED) lève l'interruption K0x à chaque appel : on ne
+  // transmet que les transitions, indépendamment de la cadence de update()
+  for (button_t btn : kButtons)
+  {
+    const uint8_t bit = 1u << btn;
+    if ((mask ^ _buttons) & bit)
+      hw_set_button(btn, (mask & bit) ? BTN_STATE_PRESSED : BTN_STATE_RELEASED);
+  }
+  _buttons = mask;
 }
 
 LogicalButton InputService::getHeld() const
@@ -20,12 +20,22 @@ enum class LogicalButton : uint8_t {
   // Boutons propres à Espgotchi
   SPEED,
   DEBUG_CENTER,
+  REWIND, // appui long sur la barre d'icônes
 
   // Ajouter ici plus tard : SETTINGS, MUTE, etc.
   // SETTINGS,
   // MUTE,
 };
 
+// Échantillon du tactile : ce que update() applique, transmissible d'un cœur
+// à l'autre (voir TamaHost, mode double cœur)
+struct InputSample
+{
+  uint8_t buttons;    // boutons Tama voulus (bits 1 << BTN_*)
+  uint8_t taps;       // taps logiques détectés (bits 1 << LogicalButton)
+  LogicalButton held; // bouton tenu (barre du bas, log HELD)
+};
+
 // Service d'entrée haut niveau pour EspGotchi
 // - encapsule EspgotchiInput (touch + mapping L/OK/R)
 // - met à jour les boutons Tama (hw_set_button)
@@ -34,8 +44,18 @@ enum class LogicalButton : uint8_t {
 class InputService {
 public:
   void begin();
+
+  // Un seul cœur : apply(sample())
   void update();
 
+  // Côté affichage : lit le tactile (boutons virtuels, taps, appui long)
+  // sans toucher à l'émulation
+  InputSample sample();
+
+  // Côté émulation : taps en attente de consumeTap(), boutons Tama appliqués
+  // (hw_set_button) sauf pendant un rejeu d'entrées
+  void apply(const InputSample &in);
+
   // Bouton actuellement "tenu" pour le bas de l’écran (L/OK/R/LR)
   LogicalButton getHeld() const;
 
@@ -46,10 +66,31 @@ public:
   // Taps ponctuels (SPD, DEBUG, etc.)
   bool consumeTap(LogicalButton b);
 
+  // Boutons Tama appliqués à TamaLIB (bits 1 << BTN_LEFT / BTN_MIDDLE / BTN_RIGHT)
+  uint8_t buttons() const { return _buttons; }
+
+  // Applique un état de boutons : hw_set_button() sur les seuls changements,
+  // un appui = un front sur K0x, comme le vrai bouton
+  void setButtons(uint8_t mask);
+
+  // false : le tactile ne pilote plus les boutons Tama (rejeu d'entrées) ;
+  // les taps SPD / DEBUG / REWIND restent actifs
+  void setLiveButtons(bool live) { _liveButtons = live; }
+
 private:
+  // Côté affichage (sample(), getHeld(), getLastTouch())
   EspgotchiInput input;
+  bool _lastTouchDown = false;
+
+  // Côté émulation (apply(), setButtons(), consumeTap())
+  uint8_t _buttons = 0;
+  bool _liveButtons = true;
 
   // Petit état interne pour les taps logiques
   bool _tapPending[8] = {false};  // taille >= nb de LogicalButton
-  bool _lastTouchDown = false;
+
+  // Appui long sur la barre d'icônes (REWIND)
+  uint32_t _pressStartMs = 0;
+  bool _pressInTopbar = false;
+  bool _longPressFired = false;
 };
@@ -0,0 +1,135 @@
+#include "LcdStream.h"
+
+extern "C"
+{
+#include "arduinogotchi_core/espgotchi_savestate.h"
+}
+
+static constexpr uint8_t KEYFRAME_BIT = 0x80;
+static constexpr uint8_t SEQ_MASK = 0x7F;
+static constexpr size_t RUN_MAX = 128;
+
+void LcdStream::reset()
+{
+  memset(_frame, 0, sizeof(_frame));
+  _seq = 0;
+  _sinceKey = 0;
+  _synced = false;
+  _stats = {};
+}
+
+size_t LcdStream::encode(const uint8_t frame[FRAME_BYTES], uint8_t out[MAX_PACKET])
+{
+  if (_synced && memcmp(frame, _frame, FRAME_BYTES) == 0)
+    return 0;
+
+  const bool key = !_synced || _sinceKey >= ESPGOTCHI_LCD_STREAM_KEYFRAME;
+  uint8_t diff[FRAME_BYTES];
+  for (size_t i = 0; i < FRAME_BYTES; i++)
+    diff[i] = key ? frame[i] : (uint8_t)(frame[i] ^ _frame[i]);
+
+  size_t end = FRAME_BYTES;
+  while (end > 0 && diff[end - 1] == 0)
+    end--;
+
+  uint8_t *p = out;
+  *p++ = (uint8_t)((key ? KEYFRAME_BIT : 0) | (_seq & SEQ_MASK));
+  for (size_t i = 0; i < end;)
+  {
+    size_t n = 0;
+    if (diff[i] == 0)
+    {
+      while (i + n < end && n < RUN_MAX && diff[i + n] == 0)
+        n++;
+      *p++ = (uint8_t)(n - 1);
+    }
+    else
+    {
+      // Un zéro isolé reste dans la suite : moins cher qu'un changement de suite
+      while (i + n < end && n < RUN_MAX && (diff[i + n] != 0 || (i + n + 1 < end && diff[i + n + 1] != 0)))
+        n++;
+      *p++ = (uint8_t)(0x80 | (n - 1));
+      memcpy(p, diff + i, n);
+      p += n;
+    }
+    i += n;
+  }
+
+  const u32_t crc = espgotchi_savestate_crc32(0, frame, FRAME_BYTES);
+  *p++ = (uint8_t)crc;
+  *p++ = (uint8_t)(crc >> 8);
+
+  memcpy(_frame, frame, FRAME_BYTES);
+  _seq = (uint8_t)((_seq + 1) & SEQ_MASK);
+  _sinceKey = key ? 0 : (uint16_t)(_sinceKey + 1);
+  _synced = true;
+
+  const size_t len = (size_t)(p - out);
+  _stats.packets++;
+  _stats.keyframes += key;
+  _stats.bytes += len;
+  return len;
+}
+
+bool LcdStream::decode(const uint8_t *packet, size_t len, uint8_t frame[FRAME_BYTES])
+{
+  if (len < 3)
+  {
+    _stats.errors++;
+    return false;
+  }
+
+  const bool key = (packet[0] & KEYFRAME_BIT) != 0;
+  const uint8_t seq = packet[0] & SEQ_MASK;
+  if (!key && (!_synced || seq != _seq))
+  {
+    // Paquet perdu en amont : les deltas suivants n'ont plus de base
+    _synced = false;
+    _stats.errors++;
+    return false;
+  }
+
+  uint8_t next[FRAME_BYTES];
+  if (key)
+    memset(next, 0, FRAME_BYTES);
+  else
+    memcpy(next, _frame, FRAME_BYTES);
+
+  const uint8_t *p = packet + 1;
+  const uint8_t *end = packet + len - 2;
+  size_t i = 0;
+  while (p < end)
+  {
+    const uint8_t c = *p++;
+    const size_t n = (size_t)(c & 0x7F) + 1;
+    if (i + n > FRAME_BYTES || ((c & 0x80) && (size_t)(end - p) < n))
+    {
+      _synced = false;
+      _stats.errors++;
+      return false;
+    }
+    if (c & 0x80)
+    {
+      for (size_t k = 0; k < n; k++)
+        next[i + k] ^= *p++;
+    }
+    i += n;
+  }
+
+  const u32_t crc = espgotchi_savestate_crc32(0, next, FRAME_BYTES);
+  if (end[0] != (uint8_t)crc || end[1] != (uint8_t)(crc >> 8))
+  {
+    _synced = false;
+    _stats.errors++;
+    return false;
+  }
+
+  memcpy(_frame, next, FRAME_BYTES);
+  memcpy(frame, next, FRAME_BYTES);
+  _seq = (uint8_t)((seq + 1) & SEQ_MASK);
+  _synced = true;
+  _stats.packets++;
+  _stats.keyframes += key;
+  _stats.bytes += len;
+  return true;
+}
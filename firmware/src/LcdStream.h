@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+
+extern "C"
+{
+#include "hw.h"
+}
+
+// Une image clé au plus toutes les N images envoyées (resynchronisation
+// d'un décodeur qui a raté une ligne ou s'est branché en cours de route)
+#ifndef ESPGOTCHI_LCD_STREAM_KEYFRAME
+#define ESPGOTCHI_LCD_STREAM_KEYFRAME 16
+#endif
+
+struct LcdStreamStats
+{
+  uint32_t packets;   // paquets émis / décodés
+  uint32_t keyframes; // dont images clés
+  uint32_t bytes;     // octets de paquet (avant hex)
+  uint32_t errors;    // décodage : CRC faux, séquence rompue, delta sans clé
+};
+
+// Flux compact de l'écran LCD (suivi à distance) : une image par changement
+// de contenu, codée en XOR avec la précédente puis en RLE.
+//
+// Image : matrice (LCD_HEIGHT lignes de LCD_WIDTH / 8 octets, MSB = x le plus
+// petit) | icônes (bit i = icône i).
+// Paquet : en-tête u8 (bit 7 : image clé, bits 0-6 : numéro de séquence) |
+//   RLE du XOR avec l'image précédente (image nulle pour une clé) |
+//   CRC32 de l'image, 16 bits de poids faible (petit-boutiste).
+// RLE : c < 0x80 : c + 1 octets inchangés ; c >= 0x80 : (c & 0x7F) + 1 octets
+//   XOR suivent. Les octets inchangés de fin ne sont pas codés.
+//
+// Une instance émet (encode()) ou reçoit (decode()), pas les deux.
+class LcdStream
+{
+public:
+  static constexpr size_t FRAME_BYTES = LCD_HEIGHT * (LCD_WIDTH / 8) + 1;
+  static constexpr size_t MAX_PACKET = 1 + FRAME_BYTES + (FRAME_BYTES + 127) / 128 + 2;
+
+  // Prochain paquet : image clé ; statistiques remises à zéro
+  void reset();
+
+  // Taille du paquet écrit dans out, 0 si l'image n'a pas changé
+  size_t encode(const uint8_t frame[FRAME_BYTES], uint8_t out[MAX_PACKET]);
+
+  // Applique un paquet : false (frame inchangée) si le paquet est invalide
+  // ou si un delta arrive sans l'image qui le précède (attente d'une clé)
+  bool decode(const uint8_t *packet, size_t len, uint8_t frame[FRAME_BYTES]);
+
+  const LcdStreamStats &stats() const { return _stats; }
+
+private:
+  uint8_t _frame[FRAME_BYTES] = {}; // dernière image émise / reconstruite
+  uint8_t _seq = 0;                 // prochain numéro de séquence
+  uint16_t _sinceKey = 0;           // images depuis la dernière clé
+  bool _synced = false;             // _frame valide
+  LcdStreamStats _stats = {};
+};
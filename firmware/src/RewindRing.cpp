@@ -0,0 +1,124 @@
+#include "RewindRing.h"
+#include "esp_timer.h"
+
+void RewindRing::begin(uint8_t *data, uint32_t dataBytes, RewindEntry *entries, uint16_t maxEntries)
+{
+  _data = (data && entries && maxEntries) ? data : nullptr;
+  _dataBytes = _data ? dataBytes : 0;
+  _entries = _data ? entries : nullptr;
+  _maxEntries = _data ? maxEntries : 0;
+  clear();
+}
+
+void RewindRing::clear()
+{
+  _first = 0;
+  _count = 0;
+  _wr = 0;
+  _headLen = 0;
+  _headTick = 0;
+  _lastDelta = 0;
+}
+
+void RewindRing::dropOldest()
+{
+  _first = (_first + 1) % _maxEntries;
+  _count--;
+}
+
+void RewindRing::push(const uint8_t *snap, uint16_t len, uint32_t tick)
+{
+  if (!_data || len == 0 || len > sizeof(_head))
+    return;
+
+  const int64_t t0 = esp_timer_get_time();
+
+  // Format différent (ne devrait pas arriver) : l'historique ne se rejoue plus
+  if (_headLen != 0 && _headLen != len)
+    clear();
+
+  if (_headLen != 0)
+  {
+    // Delta arrière : reconstruit l'ancien point à partir du nouveau
+    const uint16_t n = (uint16_t)espgotchi_savestate_delta_encode(_head, snap, len, _scratch);
+
+    if (n > _dataBytes)
+    {
+      // Delta plus gros que le tampon : les deltas retenus partent de
+      // l'ancien point, ils ne se rejoueraient pas sur le nouveau.
+      // L'historique repart de ce point.
+      clear();
+    }
+    else
+    {
+      if (_wr + n > _dataBytes)
+      {
+        // Retour au début : la fin du tampon ne contient que les plus anciens
+        while (_count > 0 && entry(0).offset >= _wr)
+          dropOldest();
+        _wr = 0;
+      }
+
+      // Évince les plus anciens deltas qui recouvrent la zone à écrire
+      while (_count > 0)
+      {
+        const RewindEntry &old = entry(0);
+        const bool overlaps = old.offset < _wr + n && old.offset + old.len > _wr;
+        if (!overlaps && _count < _maxEntries)
+          break;
+        dropOldest();
+      }
+
+      RewindEntry &e = entry(_count);
+      e.offset = _wr;
+      e.len = n;
+      e.tick = _headTick;
+      memcpy(_data + _wr, _scratch, n);
+      _wr += n;
+      _count++;
+    }
+    _lastDelta = n;
+  }
+
+  memcpy(_head, snap, len);
+  _headLen = len;
+  _headTick = tick;
+  _lastPushUs = (uint32_t)(esp_timer_get_time() - t0);
+}
+
+uint16_t RewindRing::rewind(uint16_t steps, uint8_t *out)
+{
+  if (_headLen == 0 || steps > _count)
+    return 0;
+
+  // Du plus récent vers le point visé, un delta à la fois
+  memcpy(out, _head, _headLen);
+  for (uint16_t k = 0; k < steps; k++)
+  {
+    const RewindEntry &e = entry(_count - 1 - k);
+    espgotchi_savestate_delta_apply(_data + e.offset, e.len, out, _headLen);
+  }
+
+  // Le point visé devient le plus récent : les deltas plus récents sont oubliés
+  if (steps > 0)
+  {
+    _headTick = entry(_count - steps).tick;
+    _count -= steps;
+    memcpy(_head, out, _headLen);
+    _wr = _count ? entry(_count - 1).offset + entry(_count - 1).len : 0;
+  }
+  return _headLen;
+}
+
+void RewindRing::getStats(RewindStats &out) const
+{
+  out.points = points();
+  out.memoryBytes = _data ? _dataBytes + _maxEntries * sizeof(RewindEntry) + sizeof(_head) : 0;
+  out.dataBytes = _dataBytes;
+  out.dataUsed = 0;
+  for (uint16_t i = 0; i < _count; i++)
+    out.dataUsed += entry(i).len;
+  out.spanTicks = _count ? _headTick - entry(0).tick : 0;
+  out.lastDelta = _lastDelta;
+  out.lastPushUs = _lastPushUs;
+}
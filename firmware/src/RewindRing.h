@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+
+extern "C"
+{
+#include "arduinogotchi_core/espgotchi_savestate.h"
+}
+
+// Point de retour retenu (hors le plus récent, gardé en clair)
+struct RewindEntry
+{
+  uint32_t offset; // position du delta dans le tampon
+  uint16_t len;    // taille du delta compressé
+  uint32_t tick;   // tick_counter du point reconstruit
+};
+
+struct RewindStats
+{
+  uint16_t points;        // points de retour disponibles (le plus récent compris)
+  uint32_t memoryBytes;   // mémoire allouée (tampon + index + instantané courant)
+  uint32_t dataUsed;      // octets de deltas retenus
+  uint32_t dataBytes;     // taille du tampon de deltas
+  uint32_t spanTicks;     // ticks entre le plus ancien et le plus récent point
+  uint16_t lastDelta;     // taille du dernier delta compressé
+  uint32_t lastPushUs;    // durée du dernier instantané (capture + compression)
+};
+
+// Anneau de save-states pour le rewind.
+// Le point le plus récent est gardé en clair ; chaque point plus ancien est
+// un delta arrière (espgotchi_savestate_delta_encode() avec le point suivant : la plupart
+// des nibbles de RAM ne changent pas d'un instantané à l'autre). Revenir de
+// k points rejoue k deltas depuis le plus récent ; le plus ancien point peut
+// être évincé sans rien reconstruire.
+class RewindRing
+{
+public:
+  // data / entries alloués par l'appelant (TamaHost : hal_malloc, PSRAM d'abord)
+  void begin(uint8_t *data, uint32_t dataBytes, RewindEntry *entries, uint16_t maxEntries);
+  bool enabled() const { return _data != nullptr; }
+
+  // Nouveau point (instantané espgotchi_savestate complet)
+  void push(const uint8_t *snap, uint16_t len, uint32_t tick);
+
+  // Reconstruit le point situé steps instantanés avant le plus récent dans
+  // out (ESPGOTCHI_SAVESTATE_MAX_SIZE octets) et oublie les points plus
+  // récents. Retourne la taille de l'instantané, 0 si steps est hors anneau.
+  uint16_t rewind(uint16_t steps, uint8_t *out);
+
+  uint16_t points() const { return _count + (_headLen ? 1 : 0); }
+  void getStats(RewindStats &out) const;
+  void clear();
+
+private:
+  uint8_t *_data = nullptr;
+  uint32_t _dataBytes = 0;
+  RewindEntry *_entries = nullptr;
+  uint16_t _maxEntries = 0;
+
+  uint16_t _first = 0; // plus ancien delta
+  uint16_t _count = 0;
+  uint32_t _wr = 0;    // prochaine écriture dans _data
+
+  uint8_t _head[ESPGOTCHI_SAVESTATE_MAX_SIZE];
+  uint16_t _headLen = 0;
+  uint32_t _headTick = 0;
+
+  uint8_t _scratch[ESPGOTCHI_SAVESTATE_DELTA_MAX(ESPGOTCHI_SAVESTATE_MAX_SIZE)];
+  uint16_t _lastDelta = 0;
+  uint32_t _lastPushUs = 0;
+
+  RewindEntry &entry(uint16_t i) { return _entries[(_first + i) % _maxEntries]; }
+  const RewindEntry &entry(uint16_t i) const { return _entries[(_first + i) % _maxEntries]; }
+  void dropOldest();
+};
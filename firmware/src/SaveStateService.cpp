@@ -0,0 +1,451 @@
+#include "SaveStateService.h"
+#include "TamaHost.h"
+#include "esp_timer.h"
+
+#ifndef ESPGOTCHI_NATIVE
+#include <esp_partition.h>
+#include <freertos/semphr.h>
+#endif
+
+// Enregistrement : [magic u16][type u8][0xFF][seq u32][len u16][snapLen u16][crc u32][données]
+// crc = CRC32 des 12 premiers octets de l'en-tête puis des données ; aligné sur 4 octets
+static constexpr uint16_t RECORD_MAGIC = 0xC4EC;
+static constexpr uint8_t RECORD_BASE = 1;
+static constexpr uint8_t RECORD_DELTA = 2;
+
+static inline uint32_t recordSpan(uint16_t len)
+{
+  return (16 + len + 3) & ~3u;
+}
+
+// ---------------------------------------------------------------------------
+// Accès au stockage
+// ---------------------------------------------------------------------------
+
+#ifdef ESPGOTCHI_NATIVE
+
+bool SaveStateService::begin(const char *path)
+{
+  _file = fopen(path, "r+b");
+  long size = -1;
+  if (_file && fseek(_file, 0, SEEK_END) == 0)
+    size = ftell(_file);
+
+  // Absent ou d'un autre format : image neuve, entièrement "effacée" (0xFF)
+  if (size != ESPGOTCHI_CHECKPOINT_NATIVE_BYTES)
+  {
+    if (_file)
+    {
+      fclose(_file);
+      Serial.printf("[SaveState] %s: not a checkpoint log, reformatted\n", path);
+    }
+    _file = fopen(path, "w+b");
+    if (!_file)
+      return false;
+    _sectors = ESPGOTCHI_CHECKPOINT_NATIVE_BYTES / SECTOR_SIZE;
+    for (uint32_t s = 0; s < _sectors; s++)
+      flashErase(s);
+    _erases = 0;
+  }
+
+  _sectors = ESPGOTCHI_CHECKPOINT_NATIVE_BYTES / SECTOR_SIZE;
+  _startMs = millis();
+  Serial.printf("[SaveState] log %s: %u sectors\n", path, (unsigned)_sectors);
+  return _sectors >= 3;
+}
+
+bool SaveStateService::flashRead(uint32_t offset, void *dst, uint32_t len)
+{
+  return _file && fseek(_file, (long)offset, SEEK_SET) == 0 && fread(dst, 1, len, _file) == len;
+}
+
+bool SaveStateService::flashWrite(uint32_t offset, const void *src, uint32_t len)
+{
+  return _file && fseek(_file, (long)offset, SEEK_SET) == 0 && fwrite(src, 1, len, _file) == len &&
+         fflush(_file) == 0;
+}
+
+bool SaveStateService::flashErase(uint32_t sector)
+{
+  uint8_t blank[256];
+  memset(blank, 0xFF, sizeof(blank));
+  for (uint32_t off = 0; off < SECTOR_SIZE; off += sizeof(blank))
+  {
+    if (!flashWrite(sector * SECTOR_SIZE + off, blank, sizeof(blank)))
+      return false;
+  }
+  _erases++;
+  return true;
+}
+
+uint32_t SaveStateService::flashWindowWanted() const
+{
+  return 0;
+}
+
+void SaveStateService::grantFlashWindow()
+{
+}
+
+void SaveStateService::waitFlashWindow(uint32_t us)
+{
+  (void)us;
+}
+
+bool SaveStateService::save(TamaHost &host)
+{
+  const int64_t t0 = esp_timer_get_time();
+  const size_t len = host.saveState(_pending, sizeof(_pending));
+  if (len == 0 || !_file)
+    return false;
+
+  // Pas de tâche de fond en natif : écriture directe
+  append(_pending, (uint16_t)len);
+  const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+  if (us > _worstSubmitUs)
+    _worstSubmitUs = us;
+  return true;
+}
+
+#else
+
+bool SaveStateService::begin(const char *path)
+{
+  (void)path;
+
+  const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                         ESPGOTCHI_SAVESTATE_PARTITION);
+  if (!part)
+  {
+    Serial.printf("[SaveState] partition '%s' not found\n", ESPGOTCHI_SAVESTATE_PARTITION);
+    return false;
+  }
+
+  _partition = part;
+  _sectors = part->size / SECTOR_SIZE;
+  if (_sectors < 3)
+    return false;
+
+  _window = xSemaphoreCreateBinary();
+  if (!_window)
+    return false;
+
+  // Priorité au-dessus de la tâche d'affichage : une fenêtre accordée est
+  // prise tout de suite, pas après un rendu
+  TaskHandle_t task = nullptr;
+  xTaskCreatePinnedToCore(writerTask, "checkpoint", 4096, this, 2, &task, ESPGOTCHI_CHECKPOINT_CORE);
+  _task = task;
+  _startMs = millis();
+
+  Serial.printf("[SaveState] partition '%s': %u sectors, writer on core %d\n", ESPGOTCHI_SAVESTATE_PARTITION,
+                (unsigned)_sectors, ESPGOTCHI_CHECKPOINT_CORE);
+  return _task != nullptr;
+}
+
+bool SaveStateService::flashRead(uint32_t offset, void *dst, uint32_t len)
+{
+  return esp_partition_read((const esp_partition_t *)_partition, offset, dst, len) == ESP_OK;
+}
+
+bool SaveStateService::flashWrite(uint32_t offset, const void *src, uint32_t len)
+{
+  return esp_partition_write((const esp_partition_t *)_partition, offset, src, len) == ESP_OK;
+}
+
+bool SaveStateService::flashErase(uint32_t sector)
+{
+  if (esp_partition_erase_range((const esp_partition_t *)_partition, sector * SECTOR_SIZE, SECTOR_SIZE) != ESP_OK)
+    return false;
+  _erases++;
+  return true;
+}
+
+static portMUX_TYPE pendingMux = portMUX_INITIALIZER_UNLOCKED;
+
+uint32_t SaveStateService::flashWindowWanted() const
+{
+  return _windowWantedUs;
+}
+
+void SaveStateService::grantFlashWindow()
+{
+  if (!_windowWantedUs)
+    return;
+  _windowWantedUs = 0;
+  _windows++;
+  xSemaphoreGive((SemaphoreHandle_t)_window);
+}
+
+void SaveStateService::waitFlashWindow(uint32_t us)
+{
+  const int64_t t0 = esp_timer_get_time();
+  _windowWantedUs = us;
+  xSemaphoreTake((SemaphoreHandle_t)_window, portMAX_DELAY);
+  _windowWaitUs += (uint32_t)(esp_timer_get_time() - t0);
+}
+
+bool SaveStateService::save(TamaHost &host)
+{
+  if (!_task)
+    return false;
+
+  const int64_t t0 = esp_timer_get_time();
+  const size_t len = host.saveState(_work, sizeof(_work));
+  if (len == 0)
+    return false;
+
+  // _work appartient ici à la loop : l'écrivain ne s'en sert qu'après avoir
+  // récupéré _pending, sous le même verrou
+  portENTER_CRITICAL(&pendingMux);
+  if (_pendingLen)
+    _coalesced++;
+  memcpy(_pending, _work, len);
+  _pendingLen = (uint16_t)len;
+  portEXIT_CRITICAL(&pendingMux);
+  xTaskNotifyGive((TaskHandle_t)_task);
+
+  const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+  if (us > _worstSubmitUs)
+    _worstSubmitUs = us;
+  return true;
+}
+
+void SaveStateService::writerTask(void *arg)
+{
+  SaveStateService *self = (SaveStateService *)arg;
+  uint8_t snap[ESPGOTCHI_SAVESTATE_MAX_SIZE];
+
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    portENTER_CRITICAL(&pendingMux);
+    const uint16_t len = self->_pendingLen;
+    memcpy(snap, self->_pending, len);
+    self->_pendingLen = 0;
+    portEXIT_CRITICAL(&pendingMux);
+
+    if (len)
+      self->append(snap, len);
+  }
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Journal
+// ---------------------------------------------------------------------------
+
+bool SaveStateService::writeRecord(uint8_t type, const uint8_t *payload, uint16_t len, uint16_t snapLen)
+{
+  const uint32_t span = recordSpan(len);
+  const uint32_t seq = _seq + 1;
+
+  uint8_t *r = _record;
+  r[0] = RECORD_MAGIC & 0xFF;
+  r[1] = RECORD_MAGIC >> 8;
+  r[2] = type;
+  r[3] = 0xFF;
+  memcpy(r + 4, &seq, 4);
+  memcpy(r + 8, &len, 2);
+  memcpy(r + 10, &snapLen, 2);
+  memcpy(r + RECORD_HEADER, payload, len);
+  memset(r + RECORD_HEADER + len, 0xFF, span - RECORD_HEADER - len);
+  const uint32_t crc = espgotchi_savestate_crc32(espgotchi_savestate_crc32(0, r, 12), payload, len);
+  memcpy(r + 12, &crc, 4);
+
+  waitFlashWindow(ESPGOTCHI_FLASH_WRITE_WINDOW_US);
+  if (!flashWrite((uint32_t)_sector * SECTOR_SIZE + _offset, r, span))
+    return false;
+
+  _seq = seq;
+  _offset += span;
+  _bytesWritten += span;
+  _lastRecord = (uint16_t)span;
+  _checkpoints++;
+  return true;
+}
+
+void SaveStateService::append(const uint8_t *snap, uint16_t len)
+{
+  const int64_t t0 = esp_timer_get_time();
+  const uint32_t waited = _windowWaitUs;
+
+  // Delta avec le checkpoint précédent, s'il tient dans le secteur courant
+  bool written = false;
+  if (_sector >= 0 && _prevLen == len)
+  {
+    const uint32_t n = espgotchi_savestate_delta_encode(_prev, snap, len, _scratch);
+    if (n < len && _offset + recordSpan((uint16_t)n) <= SECTOR_SIZE)
+      written = writeRecord(RECORD_DELTA, _scratch, (uint16_t)n, len);
+  }
+
+  // Sinon : secteur suivant, qui repart d'une base complète
+  if (!written)
+  {
+    const uint32_t next = (uint32_t)(_sector + 1) % _sectors;
+    if ((int32_t)next != _erased)
+    {
+      waitFlashWindow(ESPGOTCHI_FLASH_ERASE_WINDOW_US);
+      if (!flashErase(next))
+        return;
+    }
+    _sector = (int32_t)next;
+    _offset = 0;
+    _erased = -1;
+    if (!writeRecord(RECORD_BASE, snap, len, len))
+      return;
+    _bases++;
+
+    // Effacement d'avance du secteur d'après (le plus ancien) : le prochain
+    // changement de secteur n'aura plus qu'à programmer. Le secteur précédent
+    // reste intact, en secours si cette base était perdue.
+    const uint32_t ahead = (next + 1) % _sectors;
+    waitFlashWindow(ESPGOTCHI_FLASH_ERASE_WINDOW_US);
+    if (flashErase(ahead))
+      _erased = (int32_t)ahead;
+  }
+
+  memcpy(_prev, snap, len);
+  _prevLen = len;
+
+  const uint32_t us = (uint32_t)(esp_timer_get_time() - t0) - (_windowWaitUs - waited);
+  if (us > _worstWriteUs)
+    _worstWriteUs = us;
+}
+
+bool SaveStateService::readRecord(uint32_t sector, uint32_t offset, uint8_t &type, uint32_t &seq, uint16_t &len,
+                                  uint16_t &snapLen, uint8_t *payload)
+{
+  uint8_t hdr[RECORD_HEADER];
+  if (offset + RECORD_HEADER > SECTOR_SIZE || !flashRead(sector * SECTOR_SIZE + offset, hdr, sizeof(hdr)))
+    return false;
+
+  uint32_t crc;
+  type = hdr[2];
+  memcpy(&seq, hdr + 4, 4);
+  memcpy(&len, hdr + 8, 2);
+  memcpy(&snapLen, hdr + 10, 2);
+  memcpy(&crc, hdr + 12, 4);
+
+  // Flash effacée (0xFF) ou en-tête incohérent : fin du secteur
+  if ((uint16_t)(hdr[0] | (hdr[1] << 8)) != RECORD_MAGIC || (type != RECORD_BASE && type != RECORD_DELTA) ||
+      len > ESPGOTCHI_SAVESTATE_MAX_SIZE || snapLen > ESPGOTCHI_SAVESTATE_MAX_SIZE ||
+      offset + recordSpan(len) > SECTOR_SIZE)
+    return false;
+
+  if (!flashRead(sector * SECTOR_SIZE + offset + RECORD_HEADER, payload, len))
+    return false;
+  return espgotchi_savestate_crc32(espgotchi_savestate_crc32(0, hdr, 12), payload, len) == crc;
+}
+
+bool SaveStateService::replaySector(uint32_t sector, uint8_t *out, uint16_t &outLen, uint32_t &lastSeq,
+                                    uint32_t &records)
+{
+  uint8_t type;
+  uint32_t seq;
+  uint16_t len, snapLen;
+  if (!readRecord(sector, 0, type, seq, len, snapLen, out) || type != RECORD_BASE || len != snapLen)
+    return false;
+
+  outLen = len;
+  lastSeq = seq;
+  records = 1;
+
+  // Deltas à la suite, jusqu'au premier enregistrement absent ou abîmé
+  uint32_t offset = recordSpan(len);
+  while (readRecord(sector, offset, type, seq, len, snapLen, _scratch) && type == RECORD_DELTA &&
+         seq == lastSeq + 1 && snapLen == outLen)
+  {
+    espgotchi_savestate_delta_apply(_scratch, len, out, outLen);
+    lastSeq = seq;
+    records++;
+    offset += recordSpan(len);
+  }
+  return true;
+}
+
+bool SaveStateService::load(TamaHost &host)
+{
+  if (_sectors == 0)
+    return false;
+
+  // Secteurs classés par numéro de séquence de leur base, du plus récent au plus ancien
+  uint32_t tried = 0;
+  uint32_t below = 0xFFFFFFFFu;
+  while (tried < _sectors)
+  {
+    int32_t best = -1;
+    uint32_t bestSeq = 0;
+    for (uint32_t s = 0; s < _sectors; s++)
+    {
+      uint8_t hdr[RECORD_HEADER];
+      uint32_t seq;
+      if (!flashRead(s * SECTOR_SIZE, hdr, sizeof(hdr)))
+        continue;
+      memcpy(&seq, hdr + 4, 4);
+      if ((uint16_t)(hdr[0] | (hdr[1] << 8)) == RECORD_MAGIC && hdr[2] == RECORD_BASE && seq < below &&
+          (best < 0 || seq > bestSeq))
+      {
+        best = (int32_t)s;
+        bestSeq = seq;
+      }
+    }
+    if (best < 0)
+      break;
+    below = bestSeq;
+    tried++;
+
+    uint16_t len;
+    uint32_t lastSeq, records;
+    const int64_t t0 = esp_timer_get_time();
+    if (replaySector((uint32_t)best, _prev, len, lastSeq, records) && host.loadState(_prev, len))
+    {
+      // La fin du secteur peut être à moitié écrite : le prochain checkpoint
+      // repart d'une base dans le secteur suivant
+      if (_seq < lastSeq)
+        _seq = lastSeq;
+      _sector = best;
+      _offset = SECTOR_SIZE;
+      _prevLen = 0;
+
+      Serial.printf("[SaveState] restored sector %ld (seq=%lu, base + %lu deltas) in %lu us\n", (long)best,
+                    (unsigned long)lastSeq, (unsigned long)(records - 1),
+                    (unsigned long)(esp_timer_get_time() - t0));
+      return true;
+    }
+
+    // Base la plus récente illisible : le numéro de séquence continue quand même
+    if (_seq < bestSeq)
+      _seq = bestSeq;
+  }
+
+  Serial.println("[SaveState] no valid checkpoint found");
+  return false;
+}
+
+void SaveStateService::getStats(CheckpointStats &out) const
+{
+  const uint32_t elapsed = millis() - _startMs;
+  out.checkpoints = _checkpoints;
+  out.bases = _bases;
+  out.coalesced = _coalesced;
+  out.bytesWritten = _bytesWritten;
+  out.erases = _erases;
+  out.windows = _windows;
+  out.bytesPerHour = elapsed ? (uint32_t)((uint64_t)_bytesWritten * 3600000ull / elapsed) : 0;
+  out.lastRecord = _lastRecord;
+  out.worstSubmitUs = _worstSubmitUs;
+  out.worstWriteUs = _worstWriteUs;
+}
+
+void SaveStateService::printStats() const
+{
+  CheckpointStats s;
+  getStats(s);
+  Serial.printf("[SaveState] %lu checkpoints (%lu bases, %lu coalesced), last=%u B, %lu B written "
+                "(%lu B/h), %lu erases, %lu flash windows, worst submit=%lu us, worst write=%lu us\n",
+                (unsigned long)s.checkpoints, (unsigned long)s.bases, (unsigned long)s.coalesced,
+                (unsigned)s.lastRecord, (unsigned long)s.bytesWritten, (unsigned long)s.bytesPerHour,
+                (unsigned long)s.erases, (unsigned long)s.windows, (unsigned long)s.worstSubmitUs, (unsigned long)s.worstWriteUs);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <Arduino.h>
+
+extern "C"
+{
+#include "arduinogotchi_core/espgotchi_savestate.h"
+}
+
+class TamaHost;
+
+// Label de la partition data dédiée sur l'ESP32 (partitions_espgotchi.csv :
+// "espgotchi", 64 Ko). Écrite en brut, sans système de fichiers.
+#ifndef ESPGOTCHI_SAVESTATE_PARTITION
+#define ESPGOTCHI_SAVESTATE_PARTITION "espgotchi"
+#endif
+
+// Taille de l'image du journal en natif (fichier)
+#ifndef ESPGOTCHI_CHECKPOINT_NATIVE_BYTES
+#define ESPGOTCHI_CHECKPOINT_NATIVE_BYTES 65536
+#endif
+
+// Tâche d'écriture flash (ESP32) : cœur 0, la loop Arduino tourne sur le cœur 1
+#ifndef ESPGOTCHI_CHECKPOINT_CORE
+#define ESPGOTCHI_CHECKPOINT_CORE 0
+#endif
+
+// Fenêtres flash (ESP32) : avance que la loop prend sur le temps réel avant
+// que l'écrivain programme un enregistrement ou efface un secteur (voir
+// TamaHost::runAhead()). Effacement 4 Ko : ~45 ms typiques sur les flash
+// SPI NOR courantes, bien plus dans le pire cas (le retard se voit alors
+// dans "[SaveState] worst emulation lag").
+#ifndef ESPGOTCHI_FLASH_WRITE_WINDOW_US
+#define ESPGOTCHI_FLASH_WRITE_WINDOW_US 5000
+#endif
+#ifndef ESPGOTCHI_FLASH_ERASE_WINDOW_US
+#define ESPGOTCHI_FLASH_ERASE_WINDOW_US 60000
+#endif
+
+struct CheckpointStats
+{
+  uint32_t checkpoints;   // checkpoints écrits (bases + deltas)
+  uint32_t bases;         // dont instantanés complets (un par secteur)
+  uint32_t coalesced;     // checkpoints remplacés avant d'être écrits (écrivain occupé)
+  uint32_t bytesWritten;  // octets programmés en flash (en-têtes compris)
+  uint32_t erases;        // secteurs effacés
+  uint32_t windows;       // fenêtres flash accordées par la loop
+  uint32_t bytesPerHour;  // bytesWritten rapporté au temps écoulé depuis begin()
+  uint16_t lastRecord;    // taille du dernier enregistrement
+  uint32_t worstSubmitUs; // pire coût côté loop (capture + copie)
+  uint32_t worstWriteUs;  // pire écriture côté écrivain (effacement compris, attente des fenêtres exclue)
+};
+
+// Journal de checkpoints (format des instantanés : espgotchi_savestate.h)
+// La partition est découpée en secteurs de 4 Ko utilisés à tour de rôle :
+//   - chaque secteur commence par un instantané complet (base), suivi de
+//     deltas (espgotchi_savestate_delta_encode() avec le checkpoint
+//     précédent : registres et nibbles modifiés seulement, ~140 octets),
+//   - secteur plein : on passe au suivant avec une nouvelle base ; c'est le
+//     compactage du journal, et l'usure tourne sur toute la partition,
+//   - le secteur d'après est effacé d'avance, juste après la base : un
+//     checkpoint ne fait que programmer quelques centaines d'octets,
+//   - reprise : base la plus récente + deltas à la suite jusqu'au premier
+//     enregistrement invalide (coupure) ; secteur précédent si la base
+//     elle-même est abîmée.
+// ESP32 : save() capture l'instantané et le confie à une tâche FreeRTOS.
+// Pendant un effacement ou une programmation, ESP-IDF arrête l'autre cœur
+// et le cache flash : la ROM, le cache de blocs et TamaLIB n'y sont pas
+// accessibles, IRAM_ATTR ne suffirait pas. L'écrivain attend donc que la
+// loop lui ouvre une fenêtre (flashWindowWanted() / grantFlashWindow(),
+// après TamaHost::runAhead()) avant chaque opération flash.
+// Natif : même journal dans un fichier image, écrit directement.
+class SaveStateService
+{
+public:
+  // ESP32 : localise la partition, démarre la tâche d'écriture.
+  // Natif : path = fichier image du journal (créé au besoin).
+  bool begin(const char *path = "espgotchi.log");
+
+  // Checkpoint de l'état courant. ESP32 : ne bloque jamais (le précédent
+  // checkpoint, s'il n'est pas encore écrit, est remplacé).
+  bool save(TamaHost &host);
+
+  // Reprise du dernier checkpoint valide (à appeler avant le premier save())
+  bool load(TamaHost &host);
+
+  // ESP32 : durée de la fenêtre flash que l'écrivain attend (µs), 0 sinon.
+  // La loop avance l'émulation d'autant puis appelle grantFlashWindow().
+  // Natif : toujours 0, le fichier est écrit directement.
+  uint32_t flashWindowWanted() const;
+  void grantFlashWindow();
+
+  void getStats(CheckpointStats &out) const;
+  void printStats() const;
+
+private:
+  static constexpr uint32_t SECTOR_SIZE = 4096;
+  static constexpr uint32_t RECORD_HEADER = 16;
+
+  uint32_t _sectors = 0;
+
+  // Écrivain (tâche flash) : dernier checkpoint écrit et position dans le journal
+  int32_t _sector = -1;  // secteur courant (-1 : aucun)
+  uint32_t _offset = 0;  // prochaine écriture dans le secteur courant
+  int32_t _erased = -1;  // secteur déjà effacé d'avance
+  uint32_t _seq = 0;     // dernier numéro de séquence écrit
+  uint8_t _prev[ESPGOTCHI_SAVESTATE_MAX_SIZE];
+  uint16_t _prevLen = 0;
+  uint8_t _scratch[ESPGOTCHI_SAVESTATE_DELTA_MAX(ESPGOTCHI_SAVESTATE_MAX_SIZE)];
+  uint8_t _record[RECORD_HEADER + ESPGOTCHI_SAVESTATE_MAX_SIZE + 4];
+
+  // Checkpoint capturé par la loop, en attente de l'écrivain
+  uint8_t _pending[ESPGOTCHI_SAVESTATE_MAX_SIZE];
+  uint16_t _pendingLen = 0;
+  uint8_t _work[ESPGOTCHI_SAVESTATE_MAX_SIZE];
+
+  // Mesures
+  uint32_t _startMs = 0;
+  uint32_t _checkpoints = 0;
+  uint32_t _bases = 0;
+  uint32_t _coalesced = 0;
+  uint32_t _bytesWritten = 0;
+  uint32_t _erases = 0;
+  uint32_t _windows = 0;
+  uint32_t _windowWaitUs = 0; // attente cumulée des fenêtres flash
+  uint16_t _lastRecord = 0;
+  uint32_t _worstSubmitUs = 0;
+  uint32_t _worstWriteUs = 0;
+
+#ifdef ESPGOTCHI_NATIVE
+  FILE *_file = nullptr;
+#else
+  const void *_partition = nullptr; // esp_partition_t
+  void *_task = nullptr;            // TaskHandle_t
+  void *_window = nullptr;          // SemaphoreHandle_t : fenêtre accordée
+  volatile uint32_t _windowWantedUs = 0;
+
+  static void writerTask(void *arg);
+#endif
+
+  // Attend une fenêtre de us (ESP32), rien en natif
+  void waitFlashWindow(uint32_t us);
+
+  void append(const uint8_t *snap, uint16_t len);
+  bool writeRecord(uint8_t type, const uint8_t *payload, uint16_t len, uint16_t snapLen);
+  bool readRecord(uint32_t sector, uint32_t offset, uint8_t &type, uint32_t &seq, uint16_t &len,
+                  uint16_t &snapLen, uint8_t *payload);
+  bool replaySector(uint32_t sector, uint8_t *out, uint16_t &outLen, uint32_t &lastSeq, uint32_t &records);
+
+  // Accès brut à la zone de stockage (partition ou fichier)
+  bool flashRead(uint32_t offset, void *dst, uint32_t len);
+  bool flashWrite(uint32_t offset, const void *src, uint32_t len);
+  bool flashErase(uint32_t sector);
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// File sans verrou à un seul producteur et un seul consommateur (un cœur
+// chacun) : chaque indice n'est écrit que par son côté, et l'élément est
+// publié par l'ordre release/acquire sur l'indice. Aucun appel ne bloque ;
+// N (puissance de 2) éléments au plus, indices libres de déborder.
+template <typename T, uint32_t N>
+class SpscQueue
+{
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue: N must be a power of two");
+
+public:
+  // Producteur : false si la file est pleine (élément non ajouté)
+  bool push(const T &item)
+  {
+    const uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) == N)
+      return false;
+    _items[head & (N - 1)] = item;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consommateur : false si la file est vide
+  bool pop(T &item)
+  {
+    const uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (_head.load(std::memory_order_acquire) == tail)
+      return false;
+    item = _items[tail & (N - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximatif vu de l'autre côté (statistiques seulement)
+  uint32_t size() const
+  {
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+  }
+
+private:
+  T _items[N];
+  std::atomic<uint32_t> _head{0}; // écrit par le producteur
+  std::atomic<uint32_t> _tail{0}; // écrit par le consommateur
+};
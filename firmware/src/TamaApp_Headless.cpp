@@ -13,11 +13,25 @@ extern "C"
 #include "InputService.h"
 #include "AudioService.h"
 #include "TamaHost.h"
+#include "SaveStateService.h"
+#include "WallClock.h"
 #include "esp_timer.h"
 
 /**** Tama Setting ****/
 #define TAMA_DISPLAY_FRAMERATE 3
 
+// Période des checkpoints (ms, 0 = désactivés). Un checkpoint ne coûte à la
+// loop qu'une capture (~100 µs) ; l'écriture flash (~150 octets de delta) se
+// fait en tâche de fond, dans une fenêtre où l'émulation a pris de l'avance.
+#ifndef ESPGOTCHI_AUTOSAVE_MS
+#define ESPGOTCHI_AUTOSAVE_MS 10000
+#endif
+
+// Période du bilan du journal (octets écrits / heure, pire retard de l'émulation)
+#ifndef ESPGOTCHI_CHECKPOINT_STATS_MS
+#define ESPGOTCHI_CHECKPOINT_STATS_MS 300000
+#endif
+
 /**********************/
 
 // Service vidéo
@@ -32,6 +46,11 @@ static AudioService audio;
 // Service TamaHost
 static TamaHost host(video, input);
 
+// Save-states (journal de checkpoints en partition flash)
+static SaveStateService saves;
+static uint32_t lastAutosaveMs = 0;
+static uint32_t lastStatsMs = 0;
+
 // Glue audio utilisée par TamaHost
 void espgotchi_hal_set_frequency(u32_t freq)
 {
@@ -62,10 +81,9 @@ void setup()
   video.initDisplay();
   video.begin();
 
-  // Splash écran de boot
+  // Splash écran de boot (reste affiché pendant le rattrapage)
   video.showSplash("Kharn27 EspGotchi");
   delay(2500);
-  video.clearScreen();
 
   // Audio
   audio.begin();
@@ -84,10 +102,46 @@ audio.setVolume(128);
   // Hôte TamaLIB (HAL, temps virtuel, handler, etc.)
   host.begin(TAMA_DISPLAY_FRAMERATE, 1000000);
 
+  // Reprise du dernier save-state s'il y en a un, puis rattrapage du temps
+  // passé éteint (à vitesse MAX, sans rendu ni son) si l'heure est connue
+  WallClock::sync();
+  if (saves.begin() && saves.load(host))
+    host.catchUp();
+  lastAutosaveMs = millis();
+  lastStatsMs = lastAutosaveMs;
+  video.clearScreen();
+
+  // Émulation dans loop() (ce cœur), affichage / tactile / son sur l'autre
+  if (ESPGOTCHI_DUAL_CORE)
+    host.startDualCore();
+
   Serial.println("[Espgotchi] Step Refactoring Service started.");
 }
 
 void loop()
 {
   host.loopOnce();
+
+  if (ESPGOTCHI_AUTOSAVE_MS && millis() - lastAutosaveMs >= ESPGOTCHI_AUTOSAVE_MS)
+  {
+    lastAutosaveMs = millis();
+    saves.save(host);
+  }
+
+  // L'écrivain attend une fenêtre pour toucher la flash : on émule d'avance
+  // la durée demandée, le gel du cache tombe pendant l'attente qui suit
+  const uint32_t windowUs = saves.flashWindowWanted();
+  if (windowUs)
+  {
+    host.runAhead(windowUs);
+    saves.grantFlashWindow();
+  }
+
+  if (ESPGOTCHI_CHECKPOINT_STATS_MS && millis() - lastStatsMs >= ESPGOTCHI_CHECKPOINT_STATS_MS)
+  {
+    lastStatsMs = millis();
+    saves.printStats();
+    // Pire retard de l'émulation sur le temps réel : gels flash compris
+    Serial.printf("[SaveState] worst emulation lag=%lu us\n", (unsigned long)host.takeWorstLateUs());
+  }
 }
@@ -1,6 +1,7 @@
 #include "TamaHost.h"
 #include "VideoService.h"
 #include "InputService.h"
+#include "WallClock.h"
 #include "esp_timer.h"
 #include <esp_heap_caps.h>
 #include <stdarg.h>
@@ -9,15 +10,52 @@ extern "C"
 {
 #include "cpu.h"
 #include "arduinogotchi_core/espgotchi_state.h"
+#include "arduinogotchi_core/espgotchi_tama_rom.h"
 }
 
 // pour le bouton debug centre écran
 extern void printHeapStats();
 
-// timeMult global : facteur de vitesse (x1, x2, x4, x8) pour TamaLIB
+// Glue audio (TamaApp_Headless / NativeMain), appelée par le cœur qui sert le son
+extern void espgotchi_hal_set_frequency(u32_t freqHz);
+extern void espgotchi_hal_play_frequency(bool_t en);
+
+// timeMult global : facteur de vitesse (x1, x2, x4, x8, MAX) pour TamaLIB
 // et affichage de "SPD xN" dans la top bar.
 uint8_t timeMult = 1;
 
+// Vitesse réellement atteinte (temps émulé / temps réel), arrondie.
+// Affichée sur le bouton SPD en mode MAX.
+uint16_t achievedSpeed = 1;
+
+// Fréquence de l'horloge interne du E0C6S46 (tick_counter de TamaLIB)
+static constexpr u32_t TAMA_TICK_FREQUENCY = 32768;
+
+// Période de rafraîchissement de la barre de progression du rattrapage
+static constexpr int64_t CATCHUP_PROGRESS_US = 250000;
+
+// Rattrapage : durée de la sonde (émulation exacte du début de l'écart) qui
+// mesure la vitesse atteinte et vérifie que l'horloge du pet tourne, et
+// écart toléré entre cette horloge et le temps émulé pendant la sonde
+static constexpr int64_t CATCHUP_PROBE_US = 1000000;
+static constexpr uint32_t CATCHUP_CLOCK_TOLERANCE_S = 2;
+
+// Fenêtre de mesure de la vitesse atteinte (et de la charge des cœurs)
+static constexpr uint32_t SPEED_SAMPLE_MS = 1000;
+
+// Mode MAX : taille d'une rafale d'instructions entre deux lectures d'horloge,
+// et durée d'une rafale avant de rendre la main au handler / à l'écran.
+static constexpr uint16_t MAX_BURST_STEPS = 256;
+static constexpr int64_t MAX_BURST_US = 2000;
+
+// Moteurs décodé/blocs : instructions par appel à executeSlice() (~2 périodes
+// du timer 256 Hz), entre deux contrôles de cadence ou d'horloge.
+static constexpr u32_t FAST_SLICE_MAX_INSTR = 64;
+
+// Rejeu d'entrées : ticks maximaux d'un pas (RETS/RETD 12 cycles +
+// interruption servie 12 cycles), pour borner un lot avant une échéance
+static constexpr u32_t REPLAY_STEP_MAX_TICKS = 24;
+
 TamaHost *TamaHost::s_instance = nullptr;
 
 // HAL statique
@@ -48,16 +86,623 @@ void TamaHost::begin(uint8_t displayFramerate, uint32_t startTimestampUs)
 
   // On mémorise la fréquence utilisée pour TamaLIB (chez toi: 1_000_000 = us)
   _tamaTsFreq = startTimestampUs;
-  _lastScreenUpdateTs = 0;
+  _screenPending = true; // première trame, même si l'écran émulé est vide
 
   tamalib_register_hal(&s_hal);
   tamalib_set_framerate(displayFramerate);
   tamalib_init_espgotchi(startTimestampUs);
 
-  // S'assure qu'on démarre à vitesse x1
-  cpu_set_speed(timeMult);
+  // S'assure qu'on démarre à vitesse x1 (et applique le moteur choisi)
+  setTimeMult(timeMult);
+
+  _stepCount = 0;
+  _speedSampleSteps = 0;
+  _idleTicks = 0;
+  _speedSampleIdleTicks = 0;
+  _speedSampleTicks = *cpu_get_state()->tick_counter;
+  _speedSampleMs = millis();
+  achievedSpeed = 1;
+
+  beginRewind();
+#if ESPGOTCHI_PROFILE
+  if (espgotchi_profile_begin())
+    Serial.println("[Profile] enabled (debug tap or \"profile\" to dump)");
+#endif
+#if ESPGOTCHI_TRACE
+  if (espgotchi_trace_begin(ESPGOTCHI_TRACE_ENTRIES))
+    Serial.printf("[Trace] recording, %u entries (\"trace stop\" to freeze)\n", (unsigned)ESPGOTCHI_TRACE_ENTRIES);
+#endif
 
   Serial.println("[TamaHost] HAL registered, TamaLIB started.");
+  Serial.printf("[TamaHost] CPU engine: %s\n", engineName(_engine));
+}
+
+const char *TamaHost::engineName(espgotchi_engine_t engine)
+{
+  switch (engine)
+  {
+  case ESPGOTCHI_ENGINE_BLOCK:
+    return "block";
+  case ESPGOTCHI_ENGINE_DECODED:
+    return "decoded";
+  default:
+    return "tamalib";
+  }
+}
+
+void TamaHost::setEngine(espgotchi_engine_t engine)
+{
+  _engine = engine;
+
+  // Avant begin() : le choix sera appliqué au démarrage de TamaLIB.
+  if (s_instance != this)
+    return;
+
+  // La cadence change de propriétaire (TamaLIB <-> hôte) : on réapplique
+  // la vitesse courante, ce qui resynchronise les deux bases de temps.
+  setTimeMult(timeMult);
+}
+
+// Section hôte du save-state : état VideoService + horloge murale (u32 LE)
+static constexpr size_t HOST_STATE_SIZE = VideoService::STATE_SIZE + 4;
+
+size_t TamaHost::saveState(uint8_t *buf, size_t cap)
+{
+  uint8_t host[HOST_STATE_SIZE];
+  if (_video.exportState(host, VideoService::STATE_SIZE) != VideoService::STATE_SIZE)
+    return 0;
+
+  const uint32_t wall = WallClock::now();
+  for (int i = 0; i < 4; i++)
+    host[VideoService::STATE_SIZE + i] = (uint8_t)(wall >> (8 * i));
+
+  return espgotchi_savestate_write(buf, (u32_t)cap, host, (u32_t)sizeof(host));
+}
+
+bool TamaHost::loadState(const uint8_t *buf, size_t len)
+{
+  const u8_t *video = nullptr;
+  u32_t videoLen = 0;
+
+  if (!espgotchi_savestate_read(buf, (u32_t)len, &video, &videoLen))
+    return false;
+
+  _savedWallClock = 0;
+  if (videoLen >= VideoService::STATE_SIZE)
+  {
+    _video.importState(video, VideoService::STATE_SIZE);
+    if (videoLen >= HOST_STATE_SIZE)
+    {
+      for (int i = 0; i < 4; i++)
+        _savedWallClock |= (uint32_t)video[VideoService::STATE_SIZE + i] << (8 * i);
+    }
+  }
+
+  // tick_counter a sauté : on recale cadence, mesure de vitesse et rewind dessus
+  setTimeMult(timeMult);
+  _speedSampleTicks = *cpu_get_state()->tick_counter;
+  _rewindTick = _speedSampleTicks;
+  return true;
+}
+
+CatchUpResult TamaHost::catchUp(uint32_t budgetMs)
+{
+  CatchUpResult result = {0, 0, 0, 0};
+  const uint32_t now = WallClock::now();
+  if (_savedWallClock == 0 || now <= _savedWallClock)
+  {
+    Serial.println("[CatchUp] no wall clock, skipped.");
+    return result;
+  }
+
+  const uint32_t gapS = now - _savedWallClock;
+  const uint64_t gapTicks = (uint64_t)gapS * TAMA_TICK_FREQUENCY;
+  Serial.printf("[CatchUp] device was off for %lus, fast-forwarding...\n", (unsigned long)gapS);
+
+  // Personne n'appuie pendant que l'appareil était éteint
+  _input.setButtons(0);
+
+  const uint8_t mult = timeMult;
+  setTimeMult(TIME_MULT_MAX);
+  _catchingUp = true;
+
+  // Écart sur 64 bits : plusieurs jours dépassent un tick_counter 32 bits
+  uint64_t doneTicks = 0;
+  uint32_t jumpS = 0;
+  u32_t lastTicks = *cpu_get_state()->tick_counter;
+  u32_t probeClock = 0;
+  const bool clockValid = espgotchi_read_clock(&probeClock);
+  const int64_t budgetUs = (int64_t)budgetMs * 1000;
+  const int64_t probeUs = (budgetUs / 4 < CATCHUP_PROBE_US) ? budgetUs / 4 : CATCHUP_PROBE_US;
+  bool probed = false;
+  const int64_t start = esp_timer_get_time();
+  int64_t nextProgress = start;
+
+  while (doneTicks + (uint64_t)jumpS * TAMA_TICK_FREQUENCY < gapTicks)
+  {
+    const int64_t nowUs = esp_timer_get_time();
+    if (nowUs - start >= budgetUs)
+      break;
+
+    if (!probed && nowUs - start >= probeUs)
+    {
+      probed = true;
+      jumpS = planClockJump(gapTicks - doneTicks, doneTicks, nowUs - start, budgetUs, clockValid, probeClock);
+    }
+
+    if (nowUs >= nextProgress)
+    {
+      nextProgress = nowUs + CATCHUP_PROGRESS_US;
+      const uint64_t applied = doneTicks + (uint64_t)jumpS * TAMA_TICK_FREQUENCY;
+      _video.showProgress("Catching up...", (uint8_t)(applied * 100u / gapTicks));
+    }
+
+    uint32_t done = 0;
+    while (done < MAX_BURST_STEPS)
+      done += executeSlice();
+
+    const u32_t ticks = *cpu_get_state()->tick_counter;
+    doneTicks += ticks - lastTicks;
+    lastTicks = ticks;
+  }
+
+  _catchingUp = false;
+  const uint64_t appliedTicks = doneTicks + (uint64_t)jumpS * TAMA_TICK_FREQUENCY;
+  _video.showProgress("Catching up...", (uint8_t)(appliedTicks >= gapTicks ? 100 : appliedTicks * 100u / gapTicks));
+
+  // Rétablit le buzzer dans l'état courant de l'émulation, puis la vitesse
+  cpu_refresh_hw();
+  setTimeMult(mult);
+  _speedSampleTicks = *cpu_get_state()->tick_counter;
+  _speedSampleSteps = _stepCount;
+
+  result.gapS = gapS;
+  result.doneS = (uint32_t)(doneTicks / TAMA_TICK_FREQUENCY);
+  result.jumpS = jumpS;
+  result.ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+  if (appliedTicks < gapTicks)
+    Serial.printf("[CatchUp] INCOMPLETE: emulated %lus + clock jump %lus of %lus, %lums budget reached; the pet clock "
+                  "is now %lus behind\n",
+                  (unsigned long)result.doneS, (unsigned long)jumpS, (unsigned long)gapS, (unsigned long)budgetMs,
+                  (unsigned long)(gapS - result.doneS - jumpS));
+  else
+    Serial.printf("[CatchUp] %lus applied in %lums (emulated %lus, clock jump %lus)\n", (unsigned long)gapS,
+                  (unsigned long)result.ms, (unsigned long)result.doneS, (unsigned long)jumpS);
+  return result;
+}
+
+uint32_t TamaHost::planClockJump(uint64_t leftTicks, uint64_t probeTicks, int64_t probeUs, int64_t budgetUs,
+                                 bool clockValid, u32_t probeClock)
+{
+  // Ce que l'émulation exacte couvrira dans le reste du budget, au rythme de
+  // la sonde, avec une marge : si ça suffit, pas de saut
+  const uint64_t exactTicks = probeTicks * (uint64_t)(budgetUs - probeUs) / (uint64_t)probeUs * 3u / 4u;
+  if (leftTicks <= exactTicks)
+    return 0;
+
+  // L'horloge du pet doit avoir avancé comme le temps émulé pendant la sonde
+  // (horloge réglée et qui tourne) ; sinon, pas de saut
+  const uint32_t probeS = (uint32_t)(probeTicks / TAMA_TICK_FREQUENCY);
+  u32_t clock = 0;
+  if (!clockValid || !espgotchi_read_clock(&clock))
+  {
+    Serial.println("[CatchUp] pet clock not set, no clock jump");
+    return 0;
+  }
+  const int32_t drift = (int32_t)((clock + 86400u - probeClock) % 86400u) - (int32_t)(probeS % 86400u);
+  if (drift > (int32_t)CATCHUP_CLOCK_TOLERANCE_S || drift < -(int32_t)CATCHUP_CLOCK_TOLERANCE_S)
+  {
+    Serial.printf("[CatchUp] pet clock not running (%+lds over %lus), no clock jump\n", (long)drift,
+                  (unsigned long)probeS);
+    return 0;
+  }
+
+  const uint32_t jumpS = (uint32_t)((leftTicks - exactTicks) / TAMA_TICK_FREQUENCY);
+  if (jumpS == 0 || !espgotchi_advance_clock(jumpS))
+    return 0;
+
+  Serial.printf("[CatchUp] pet clock moved forward %lus, emulating the last %lus\n", (unsigned long)jumpS,
+                (unsigned long)((leftTicks / TAMA_TICK_FREQUENCY) - jumpS));
+  return jumpS;
+}
+
+void TamaHost::beginRewind()
+{
+  if (ESPGOTCHI_REWIND_BYTES == 0)
+    return;
+
+  // Même politique que TamaLIB : PSRAM si dispo, sinon heap interne
+  uint8_t *data = (uint8_t *)hal_malloc(ESPGOTCHI_REWIND_BYTES);
+  RewindEntry *entries = (RewindEntry *)hal_malloc(ESPGOTCHI_REWIND_ENTRIES * sizeof(RewindEntry));
+  if (!data || !entries)
+  {
+    hal_free(data);
+    hal_free(entries);
+    Serial.println("[Rewind] disabled (allocation failed)");
+    return;
+  }
+
+  _rewind.begin(data, ESPGOTCHI_REWIND_BYTES, entries, ESPGOTCHI_REWIND_ENTRIES);
+  _rewindTick = *cpu_get_state()->tick_counter;
+
+  RewindStats st;
+  _rewind.getStats(st);
+  Serial.printf("[Rewind] every %us emulated, %lu bytes allocated\n", (unsigned)ESPGOTCHI_REWIND_PERIOD_S,
+                (unsigned long)st.memoryBytes);
+}
+
+void TamaHost::updateRewind()
+{
+  const u32_t ticks = *cpu_get_state()->tick_counter;
+  if (!_rewind.enabled() || ticks - _rewindTick < ESPGOTCHI_REWIND_PERIOD_S * TAMA_TICK_FREQUENCY)
+    return;
+
+  _rewindTick = ticks;
+  const size_t len = saveState(_snapBuf, sizeof(_snapBuf));
+  if (len)
+    _rewind.push(_snapBuf, (uint16_t)len, ticks);
+}
+
+bool TamaHost::rewind(uint16_t steps)
+{
+  const u32_t now = *cpu_get_state()->tick_counter;
+
+  // Un retour en arrière casse la chronologie du journal d'entrées
+  stopInputRecording();
+  stopInputReplay();
+
+  // Le point le plus récent (steps = 0) date d'au plus une période : on le
+  // compte comme le premier pas en arrière
+  const uint16_t len = (steps > 0) ? _rewind.rewind(steps - 1, _snapBuf) : 0;
+  if (len == 0 || !loadState(_snapBuf, len))
+  {
+    Serial.printf("[Rewind] %u step(s) not available (%u retained)\n", steps, _rewind.points());
+    return false;
+  }
+
+  const u32_t back = now - *cpu_get_state()->tick_counter;
+  Serial.printf("[Rewind] back %u step(s), %lus emulated\n", steps, (unsigned long)(back / TAMA_TICK_FREQUENCY));
+  return true;
+}
+
+void TamaHost::printRewindStats() const
+{
+  RewindStats st;
+  _rewind.getStats(st);
+  Serial.printf("[Rewind] %u points over %lus, deltas %lu/%lu bytes (%lu allocated), last delta %u bytes in %lu us\n",
+                st.points, (unsigned long)(st.spanTicks / TAMA_TICK_FREQUENCY), (unsigned long)st.dataUsed,
+                (unsigned long)st.dataBytes, (unsigned long)st.memoryBytes, st.lastDelta,
+                (unsigned long)st.lastPushUs);
+}
+
+void TamaHost::printProfile() const
+{
+  if (!espgotchi_profile_enabled())
+    return;
+
+  uint64_t paths[ESPGOTCHI_PROFILE_PATH_COUNT];
+  espgotchi_profile_get_paths(paths);
+  Serial.printf("[Profile] engine=%llu step=%llu halt=%llu\n", (unsigned long long)paths[ESPGOTCHI_PROFILE_ENGINE],
+                (unsigned long long)paths[ESPGOTCHI_PROFILE_STEP], (unsigned long long)paths[ESPGOTCHI_PROFILE_HALT]);
+
+  // Classes d'opcode triées par cycles (le temps émulé, pas le nombre)
+  static espgotchi_profile_op_t ops[ESPGOTCHI_OP_COUNT];
+  espgotchi_profile_get_ops(ops);
+  uint64_t total = 0;
+  for (uint8_t k = 0; k < ESPGOTCHI_OP_COUNT; k++)
+    total += ops[k].cycles;
+
+  uint8_t order[ESPGOTCHI_OP_COUNT];
+  for (uint8_t k = 0; k < ESPGOTCHI_OP_COUNT; k++)
+  {
+    uint8_t j = k;
+    while (j > 0 && ops[order[j - 1]].cycles < ops[k].cycles)
+    {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = k;
+  }
+
+  Serial.println("[Profile] top opcodes (count, cycles, % cycles):");
+  for (uint8_t k = 0; k < 16 && ops[order[k]].count; k++)
+  {
+    const espgotchi_profile_op_t &op = ops[order[k]];
+    Serial.printf("  %-9s %10llu %11llu %5.1f%%\n", espgotchi_op_name(order[k]), (unsigned long long)op.count,
+                  (unsigned long long)op.cycles, total ? op.cycles * 100.0 / total : 0.0);
+  }
+
+  u13_t pcs[16];
+  const u32_t n = espgotchi_profile_top_pcs(pcs, 16);
+  const espgotchi_decoded_op_t *prog = espgotchi_get_tama_decoded_program();
+  Serial.println("[Profile] hottest ROM addresses:");
+  for (u32_t k = 0; k < n; k++)
+    Serial.printf("  %04X %-9s %10lu\n", pcs[k], espgotchi_op_name(prog[pcs[k]].kind),
+                  (unsigned long)espgotchi_profile_pc_count(pcs[k]));
+}
+
+void TamaHost::printTrace(uint32_t count) const
+{
+  const u32_t n = espgotchi_trace_count();
+  if (n == 0)
+    return;
+  if (count > n)
+    count = n;
+
+  Serial.printf("[Trace] last %lu of %lu instructions (%s)\n", (unsigned long)count, (unsigned long)n,
+                espgotchi_trace_recording() ? "recording" : "stopped");
+  char line[128];
+  const espgotchi_trace_rec_t *prev = nullptr;
+  for (u32_t i = n - count; i < n; i++)
+  {
+    const espgotchi_trace_rec_t *rec = espgotchi_trace_get(i);
+    espgotchi_trace_format(rec, prev, line, sizeof(line));
+    Serial.printf("  %s\n", line);
+    prev = rec;
+  }
+}
+
+void TamaHost::dumpTrace() const
+{
+  // Fige l'anneau le temps du dump (sinon il tourne pendant l'envoi)
+  const bool recording = espgotchi_trace_recording();
+  espgotchi_trace_stop();
+
+  const u32_t n = espgotchi_trace_count();
+  Serial.printf("[Trace] dump %lu records\n", (unsigned long)n);
+  for (u32_t i = 0; i < n; i++)
+  {
+    const espgotchi_trace_rec_t *rec = espgotchi_trace_get(i);
+    Serial.printf("TR %08lX %08lX\n", (unsigned long)rec->w0, (unsigned long)rec->w1);
+  }
+  Serial.println("[Trace] end");
+
+  if (recording)
+    espgotchi_trace_start();
+}
+
+bool TamaHost::beginInputLog()
+{
+  if (_inputLog.enabled())
+    return true;
+
+  // Même politique que le rewind : PSRAM si dispo, sinon heap interne
+  InputEvent *events = (InputEvent *)hal_malloc(ESPGOTCHI_INPUT_LOG_EVENTS * sizeof(InputEvent));
+  if (!events)
+  {
+    Serial.println("[Input] log disabled (allocation failed)");
+    return false;
+  }
+  _inputLog.begin(events, ESPGOTCHI_INPUT_LOG_EVENTS);
+  return true;
+}
+
+bool TamaHost::restoreExact(const uint8_t *snap, size_t len)
+{
+  // previous_cycles de cpu_step() n'est pas dans l'instantané : selon
+  // l'historique, le premier pas TamaLIB facturerait une durée différente et
+  // décalerait toutes les échéances. Un pas CPU arrêté le fixe à la durée
+  // d'un pas d'arrêt, puis l'instantané efface tout le reste de ce pas.
+  if (!loadState(snap, len))
+    return false;
+  *cpu_get_state()->cpu_halted = 1;
+  tamalib_step();
+  return loadState(snap, len);
+}
+
+uint32_t TamaHost::frameHash() const
+{
+  uint8_t state[VideoService::STATE_SIZE];
+  _video.exportState(state, sizeof(state));
+  return espgotchi_savestate_crc32(0, state, sizeof(state));
+}
+
+bool TamaHost::startInputRecording()
+{
+  if (!beginInputLog())
+    return false;
+  stopInputReplay();
+
+  // Départ boutons relâchés, depuis un état que le rejeu reproduira à l'identique
+  _input.setButtons(0);
+  const size_t len = saveState(_snapBuf, sizeof(_snapBuf));
+  if (len == 0 || !restoreExact(_snapBuf, len))
+  {
+    Serial.println("[Input] recording FAILED (save-state)");
+    return false;
+  }
+
+  _inputLog.startRecording(_snapBuf, (uint16_t)len, *cpu_get_state()->tick_counter, (uint8_t)_engine);
+  Serial.println("[Input] recording (\"input stop\" to end)");
+  return true;
+}
+
+void TamaHost::stopInputRecording()
+{
+  if (!_inputLog.recording())
+    return;
+
+  _inputLog.stopRecording(*cpu_get_state()->tick_counter, frameHash());
+  Serial.printf("[Input] recorded %u events over %lus emulated\n", _inputLog.eventCount(),
+                (unsigned long)(_inputLog.spanTicks() / TAMA_TICK_FREQUENCY));
+}
+
+bool TamaHost::startInputReplay()
+{
+  if (!_inputLog.hasRecording())
+  {
+    Serial.println("[Input] nothing to replay");
+    return false;
+  }
+
+  // Le choix du moteur décide où tombent les pas TamaLIB : on rejoue avec le même
+  const espgotchi_engine_t engine = (espgotchi_engine_t)_inputLog.engine();
+  if (engine != _engine)
+  {
+    setEngine(engine);
+    Serial.printf("[Input] CPU engine: %s (as recorded)\n", engineName(engine));
+  }
+
+  _input.setLiveButtons(false);
+  _input.setButtons(0);
+  if (!restoreExact(_inputLog.snapshot(), _inputLog.snapshotLen()))
+  {
+    _input.setLiveButtons(true);
+    Serial.println("[Input] replay FAILED (save-state)");
+    return false;
+  }
+
+  _inputLog.startReplay();
+  Serial.printf("[Input] replaying %u events over %lus emulated\n", _inputLog.eventCount(),
+                (unsigned long)(_inputLog.spanTicks() / TAMA_TICK_FREQUENCY));
+  return true;
+}
+
+void TamaHost::stopInputReplay()
+{
+  if (!_inputLog.replaying())
+    return;
+
+  _inputLog.abortReplay();
+  _input.setLiveButtons(true);
+  Serial.println("[Input] replay aborted");
+}
+
+u32_t TamaHost::stepInputReplay(u32_t maxInstr)
+{
+  const u32_t now = *cpu_get_state()->tick_counter;
+
+  u32_t ahead;
+  while ((ahead = _inputLog.ticksToNext(now)) == 0)
+  {
+    const InputEvent *ev = _inputLog.advance(now, frameHash());
+    if (!ev)
+    {
+      finishInputReplay();
+      return maxInstr;
+    }
+    _input.setButtons(ev->buttons);
+  }
+
+  // Lot borné pour s'arrêter pile sur l'échéance (même frontière
+  // d'instruction que l'enregistrement, quel que soit le découpage)
+  const u32_t cap = ahead / REPLAY_STEP_MAX_TICKS;
+  return (cap == 0) ? 1 : (cap < maxInstr) ? cap : maxInstr;
+}
+
+void TamaHost::finishInputReplay()
+{
+  const InputReplayStats &st = _inputLog.replayStats();
+  _input.setLiveButtons(true);
+  Serial.printf("[Input] replay done: %u/%u events, %u late, %u frame mismatches, end frame %s\n", st.applied,
+                st.events, st.late, st.hashMismatches, st.endHashOk ? "OK" : "MISMATCH");
+}
+
+bool TamaHost::loadInputRecording(const uint8_t *buf, size_t len)
+{
+  if (!beginInputLog())
+    return false;
+  stopInputReplay();
+  return _inputLog.deserialize(buf, (uint32_t)len);
+}
+
+size_t TamaHost::saveInputRecording(uint8_t *buf, size_t cap) const
+{
+  return _inputLog.serialize(buf, (uint32_t)cap);
+}
+
+void TamaHost::printInputLog() const
+{
+  static const char *const kModes[] = {"idle", "recording", "replaying"};
+  Serial.printf("[Input] %s, %u events over %lus emulated (engine %s)\n", kModes[(uint8_t)_inputLog.mode()],
+                _inputLog.eventCount(), (unsigned long)(_inputLog.spanTicks() / TAMA_TICK_FREQUENCY),
+                engineName((espgotchi_engine_t)_inputLog.engine()));
+}
+
+void TamaHost::dumpInputLog() const
+{
+  const size_t size = inputRecordingSize();
+  uint8_t *buf = size ? (uint8_t *)hal_malloc(size) : nullptr;
+  if (!buf || saveInputRecording(buf, size) != size)
+  {
+    hal_free(buf);
+    Serial.println("[Input] nothing to dump");
+    return;
+  }
+
+  Serial.printf("[Input] dump %u bytes\n", (unsigned)size);
+  for (size_t i = 0; i < size; i += 32)
+  {
+    Serial.print("IR ");
+    for (size_t k = i; k < size && k < i + 32; k++)
+      Serial.printf("%02X", buf[k]);
+    Serial.println();
+  }
+  Serial.println("[Input] end");
+  hal_free(buf);
+}
+
+void TamaHost::pollSerialCommands()
+{
+  while (Serial.available() > 0)
+  {
+    const int c = Serial.read();
+    if (c < 0)
+      break;
+
+    if (c != '\n' && c != '\r')
+    {
+      if (_serialLen < sizeof(_serialLine) - 1)
+        _serialLine[_serialLen++] = (char)c;
+      continue;
+    }
+
+    _serialLine[_serialLen] = '\0';
+    _serialLen = 0;
+
+    if (!strncmp(_serialLine, "rewind", 6))
+    {
+      const long steps = strtol(_serialLine + 6, nullptr, 10);
+      if (steps > 0)
+        rewind((uint16_t)steps);
+      else
+        printRewindStats();
+    }
+    else if (!strcmp(_serialLine, "profile reset"))
+      espgotchi_profile_reset();
+    else if (!strcmp(_serialLine, "profile"))
+      printProfile();
+    else if (!strcmp(_serialLine, "trace stop"))
+      espgotchi_trace_stop();
+    else if (!strcmp(_serialLine, "trace start"))
+      espgotchi_trace_start();
+    else if (!strcmp(_serialLine, "trace dump"))
+      dumpTrace();
+    else if (!strncmp(_serialLine, "trace", 5))
+    {
+      const long count = strtol(_serialLine + 5, nullptr, 10);
+      printTrace(count > 0 ? (uint32_t)count : 32);
+    }
+    else if (!strcmp(_serialLine, "input rec"))
+      startInputRecording();
+    else if (!strcmp(_serialLine, "input stop"))
+    {
+      stopInputReplay();
+      stopInputRecording();
+    }
+    else if (!strcmp(_serialLine, "input replay"))
+      startInputReplay();
+    else if (!strcmp(_serialLine, "input dump"))
+      dumpInputLog();
+    else if (!strcmp(_serialLine, "input"))
+      printInputLog();
+    else if (!strcmp(_serialLine, "lcd stream on") || !strcmp(_serialLine, "lcd stream off"))
+    {
+      const bool on = _serialLine[12] == 'n';
+      _video.setLcdStream(on);
+      Serial.printf("[Video] LCD stream %s\n", on ? "on" : "off");
+    }
+  }
 }
 
 void TamaHost::loopOnce()
@@ -70,51 +715,183 @@ void TamaHost::loopOnce()
   {
     // 2. On laisse TamaLIB décider quoi faire (RUN/PAUSE/STEP…) via tamalib_step().
     //    Si exec_mode == PAUSE, tamalib_step() ne fera rien – comme avant.
-    tamalib_step();
-
-    // 3. Rafraîchissement de l’écran à g_framerate fps
-    timestamp_t ts = getTimestamp(); // équivalent à hal_get_timestamp()
-
-    // Sécurité : si jamais _tamaTsFreq vaut 0 ou framerate vaut 0, on évite les divisions foireuses
-    u32_t freq = _tamaTsFreq ? _tamaTsFreq : 1000000u;
-    u8_t fr = tamalib_get_framerate();
-    if (fr == 0)
+    //    En mode MAX, on exécute une rafale pour amortir handler() et l'horloge.
+    if (timeMult == TIME_MULT_MAX)
     {
-      fr = 1;
+      runMaxBurst();
     }
-
-    if (ts - _lastScreenUpdateTs >= freq / fr)
+    else
     {
-      _lastScreenUpdateTs = ts;
-      hal_update_screen();
+      executeSlice();
+      if (_engine != ESPGOTCHI_ENGINE_TAMALIB)
+      {
+        throttleToTicks();
+      }
     }
+
+    // 3. Rafraîchissement de l’écran quand son contenu change
+    pollScreen();
+
+    // 4. Instantané de rewind toutes les ESPGOTCHI_REWIND_PERIOD_S émulées
+    updateRewind();
   }
 
-  // log "alive" toutes les 2s – inchangé
   uint32_t nowMs = millis();
+  updateSpeedStats(nowMs);
+
+  // log "alive" toutes les 2s – inchangé
   if (nowMs - _lastAliveLogMs > 2000)
   {
     _lastAliveLogMs = nowMs;
     Serial.println("[Espgotchi] mainloop alive.");
+    logCoreLoad();
+  }
+}
+
+uint32_t TamaHost::executeSlice()
+{
+  // Moteurs Espgotchi : l'ordonnanceur enchaîne les lots jusqu'à chaque
+  // échéance de timer et ne passe par tamalib_step() que pour la servir
+  // (ou pour un accès IO, une interruption) ; CPU arrêté (HALT/SLP), les pas
+  // d'arrêt jusqu'à l'échéance sont sautés d'un coup. Moteur TamaLIB : un pas.
+  return runInstructions((_engine == ESPGOTCHI_ENGINE_TAMALIB) ? 1 : FAST_SLICE_MAX_INSTR);
+}
+
+uint32_t TamaHost::runInstructions(uint32_t maxInstr)
+{
+  if (_inputLog.replaying())
+    maxInstr = stepInputReplay(maxInstr);
+  u32_t idleTicks = 0;
+  const u32_t n = espgotchi_sched_run(_engine, maxInstr, &idleTicks);
+
+  _stepCount += n;
+  _idleTicks += idleTicks;
+  return n;
+}
+
+void TamaHost::runAhead(uint32_t us)
+{
+  if (timeMult == TIME_MULT_MAX)
+    return;
+
+  // Moteurs Espgotchi : throttleToTicks() n'est pas appelé ici, la prochaine
+  // loopOnce() dormira jusqu'à ce que le temps réel rattrape l'émulation.
+  // Moteur TamaLIB : sa référence de cadence avance quand même, seule
+  // l'attente est sautée.
+  const u32_t ahead = (u32_t)(((uint64_t)us * TAMA_TICK_FREQUENCY * timeMult + 999999) / 1000000);
+  const u32_t start = *cpu_get_state()->tick_counter;
+
+  _runningAhead = true;
+  while (*cpu_get_state()->tick_counter - start < ahead)
+  {
+    executeSlice();
+  }
+  _runningAhead = false;
+
+  pollScreen();
+}
+
+uint32_t TamaHost::takeWorstLateUs()
+{
+  const uint32_t us = _worstLateUs;
+  _worstLateUs = 0;
+  return us;
+}
+
+void TamaHost::runMaxBurst()
+{
+  const int64_t start = esp_timer_get_time();
+
+  do
+  {
+    uint32_t done = 0;
+    while (done < MAX_BURST_STEPS)
+    {
+      done += executeSlice();
+    }
+  } while (esp_timer_get_time() - start < MAX_BURST_US);
+}
+
+void TamaHost::updateSpeedStats(uint32_t nowMs)
+{
+  uint32_t elapsedMs = nowMs - _speedSampleMs;
+  if (elapsedMs < SPEED_SAMPLE_MS)
+    return;
+
+  u32_t ticks = *cpu_get_state()->tick_counter;
+  u32_t emuTicks = ticks - _speedSampleTicks;
+  uint64_t steps = _stepCount - _speedSampleSteps;
+  uint64_t idle = _idleTicks - _speedSampleIdleTicks;
+
+  // ratio = (ticks / 32768 Hz) / (elapsedMs / 1000), arrondi
+  uint64_t ratio = ((uint64_t)emuTicks * 1000u + (uint64_t)TAMA_TICK_FREQUENCY * elapsedMs / 2) /
+                   ((uint64_t)TAMA_TICK_FREQUENCY * elapsedMs);
+  achievedSpeed = (ratio > 0xFFFF) ? 0xFFFF : (uint16_t)ratio;
+
+  if (timeMult == TIME_MULT_MAX)
+  {
+    Serial.printf("[Time] MAX speed x%u (%lu instr/s, idle %u%%)\n", achievedSpeed,
+                  (unsigned long)(steps * 1000u / elapsedMs),
+                  emuTicks ? (unsigned)(idle * 100u / emuTicks) : 0u);
   }
+
+  // Charge du cœur d'émulation : tout ce qui n'est pas une attente de cadence
+  const uint64_t sleptUs = _sleptUs - _loadSampleSleptUs;
+  const uint64_t windowUs = (uint64_t)elapsedMs * 1000u;
+  _emuLoad = (sleptUs >= windowUs) ? 0 : (uint8_t)(100u - sleptUs * 100u / windowUs);
+
+  _speedSampleMs = nowMs;
+  _speedSampleTicks = ticks;
+  _speedSampleSteps = _stepCount;
+  _speedSampleIdleTicks = _idleTicks;
+  _loadSampleSleptUs = _sleptUs;
 }
 
 // -------- time scaling --------
 void TamaHost::setTimeMult(uint8_t newMult)
 {
-  if (newMult < 1)
-    newMult = 1;
-
-  // Mémorise juste la valeur pour l’UI (SPD xN)
+  // Mémorise juste la valeur pour l’UI (SPD xN / MAX)
   timeMult = newMult;
 
   // Informe le CPU TamaLIB du nouveau ratio de vitesse.
-  // 1 = vitesse normale, 2 = x2, 4 = x4, 8 = x8, etc.
-  cpu_set_speed(timeMult);
+  // 1 = vitesse normale, 2 = x2, 4 = x4, 8 = x8, 0 = MAX (aucune attente).
+  // Avec les moteurs décodé/blocs, TamaLIB ne voit pas passer les lots exécutés
+  // hors cpu_step() : c'est l'hôte qui cadence (throttleToTicks) et TamaLIB
+  // tourne sans attente.
+  cpu_set_speed((_engine == ESPGOTCHI_ENGINE_TAMALIB) ? timeMult : 0);
 
   // Réaligne la base de temps pour éviter de "rattraper" le temps gagné
   // en vitesse x2/x4/x8 après un retour à x1.
   cpu_sync_ref_timestamp();
+  resyncThrottle();
+}
+
+void TamaHost::resyncThrottle()
+{
+  _throttleTicks = *cpu_get_state()->tick_counter;
+  _throttleTs = getTimestamp();
+}
+
+void TamaHost::throttleToTicks()
+{
+  if (timeMult == TIME_MULT_MAX)
+    return;
+
+  u32_t ticks = *cpu_get_state()->tick_counter - _throttleTicks;
+
+  // Avance la référence par secondes émulées entières : 32768 ticks valent
+  // exactement _tamaTsFreq / timeMult (x1..x8), les calculs restent exacts.
+  while (ticks >= TAMA_TICK_FREQUENCY)
+  {
+    _throttleTicks += TAMA_TICK_FREQUENCY;
+    _throttleTs += _tamaTsFreq / timeMult;
+    ticks -= TAMA_TICK_FREQUENCY;
+  }
+
+  // Même échéance que wait_for_cycles() de TamaLIB, mais en cumul depuis la
+  // référence : pas de dérive d'arrondi d'un lot à l'autre.
+  sleepUntil(_throttleTs + (timestamp_t)(((uint64_t)ticks * _tamaTsFreq) /
+                                         ((uint64_t)TAMA_TICK_FREQUENCY * timeMult)));
 }
 
 timestamp_t TamaHost::getTimestamp()
@@ -125,11 +902,20 @@ timestamp_t TamaHost::getTimestamp()
 
 void TamaHost::sleepUntil(timestamp_t ts)
 {
+  // Mode MAX : jamais d'attente, l'émulation va aussi vite que le core.
+  if (timeMult == TIME_MULT_MAX || _runningAhead)
+    return;
+
   // ts est exprimé dans la même base que getTimestamp()
   // (microsecondes réelles). On dort jusqu'à cette échéance.
-  int64_t remaining = (int64_t)ts - (int64_t)esp_timer_get_time();
+  const int64_t start = esp_timer_get_time();
+  int64_t remaining = (int64_t)ts - start;
   if (remaining <= 0)
+  {
+    if ((uint64_t)-remaining > _worstLateUs)
+      _worstLateUs = (uint32_t)-remaining;
     return;
+  }
 
   if (remaining >= 2000)
   {
@@ -143,45 +929,260 @@ void TamaHost::sleepUntil(timestamp_t ts)
   {
     delayMicroseconds((uint32_t)remaining);
   }
+  _sleptUs += (uint64_t)(esp_timer_get_time() - start);
+}
+
+// -------- double cœur --------
+
+bool TamaHost::startDualCore()
+{
+  if (_dualCore)
+    return true;
+
+  // Le cœur d'affichage reprend le buzzer dans l'état laissé par loop()
+  _uiAudio = _audio;
+  _audioBacklog = false;
+  _dualCore = true;
+  _uiLoadStartUs = esp_timer_get_time();
+
+#ifdef ESPGOTCHI_NATIVE
+  Serial.println("[Core] emulation and display on separate threads");
+  return true;
+#else
+  TaskHandle_t task = nullptr;
+  if (xTaskCreatePinnedToCore(uiTask, "display", ESPGOTCHI_UI_TASK_STACK, this, 1, &task, ESPGOTCHI_UI_CORE) !=
+      pdPASS)
+  {
+    _dualCore = false;
+    Serial.println("[Core] display task FAILED, single core");
+    return false;
+  }
+  Serial.printf("[Core] emulation on core %d, display/input/audio on core %d\n", xPortGetCoreID(),
+                ESPGOTCHI_UI_CORE);
+  return true;
+#endif
+}
+
+#ifndef ESPGOTCHI_NATIVE
+void TamaHost::uiTask(void *arg)
+{
+  TamaHost *self = (TamaHost *)arg;
+  for (;;)
+  {
+    self->uiLoopOnce();
+    vTaskDelay(pdMS_TO_TICKS(ESPGOTCHI_UI_POLL_MS));
+  }
+}
+#endif
+
+void TamaHost::uiLoopOnce()
+{
+  const int64_t t0 = esp_timer_get_time();
+
+  // 1) Tactile -> émulation, sur changement (taps gardés si la file est pleine)
+  InputSample in = _input.sample();
+  in.taps |= _uiTaps;
+  if (in.taps || in.buttons != _uiSent.buttons || in.held != _uiSent.held)
+  {
+    if (_inputQueue.push(in))
+    {
+      _uiSent = in;
+      _uiTaps = 0;
+    }
+    else
+      _uiTaps = in.taps;
+  }
+
+  // 2) Buzzer : chaque état reçu, dans l'ordre
+  AudioState audio;
+  while (_audioQueue.pop(audio))
+  {
+    if (audio.freqHz != _uiAudio.freqHz)
+      espgotchi_hal_set_frequency(audio.freqHz);
+    if (audio.on != _uiAudio.on)
+      espgotchi_hal_play_frequency(audio.on);
+    _uiAudio = audio;
+  }
+
+  // 3) Écran : la trame la plus récente (présenter les autres garde les
+  //    demandes de redessin complet), dessinée dès que l'intervalle minimum
+  //    le permet ; sans trame, le bouton tenu et la rémanence
+  LcdFrame frame;
+  while (_frameQueue.pop(frame))
+    _video.presentFrame(frame);
+  _video.renderScreen();
+
+  // 4) Charge du cœur d'affichage sur la dernière seconde
+  const int64_t t1 = esp_timer_get_time();
+  _uiBusyUs += (uint64_t)(t1 - t0);
+  if (t1 - _uiLoadStartUs >= (int64_t)SPEED_SAMPLE_MS * 1000)
+  {
+    const uint64_t pct = _uiBusyUs * 100u / (uint64_t)(t1 - _uiLoadStartUs);
+    _uiLoad.store(pct > 100 ? 100 : (uint8_t)pct, std::memory_order_relaxed);
+    _uiBusyUs = 0;
+    _uiLoadStartUs = t1;
+  }
+}
+
+void TamaHost::queueAudio()
+{
+  // Échec : réessayé au prochain handler(), avec l'état le plus récent
+  _audioBacklog = !_audioQueue.push(_audio);
+}
+
+void TamaHost::pollScreen()
+{
+  const uint32_t nowMs = millis();
+  if (nowMs - _screenPollMs < ESPGOTCHI_UI_POLL_MS)
+    return;
+  _screenPollMs = nowMs;
+
+  // Écran émulé modifié depuis l'examen précédent : le ROM est sans doute
+  // en train de le redessiner, la trame attend qu'il ait fini (une période
+  // sans changement) ou que le budget de latence soit épuisé
+  const uint32_t revision = _video.screenRevision();
+  const bool changing = revision != _screenRevision;
+  _screenRevision = revision;
+  if (changing && !_screenPending)
+  {
+    _screenPending = true;
+    _screenChangeMs = nowMs;
+  }
+
+  if (_screenPending)
+  {
+    const uint32_t minInterval = (timeMult == TIME_MULT_MAX) ? 1000 / RENDER_FPS : ESPGOTCHI_RENDER_MIN_INTERVAL_MS;
+    const bool settled = !changing || nowMs - _screenChangeMs >= ESPGOTCHI_RENDER_LATENCY_MS;
+    if (settled && nowMs - _screenPublishMs >= minInterval)
+    {
+      _screenPublishMs = nowMs;
+      hal_update_screen();
+      return;
+    }
+  }
+
+  // Un seul cœur : bouton tenu, zones invalidées, rémanence (le cœur
+  // d'affichage s'en charge en mode double cœur)
+  if (!_dualCore)
+    _video.renderScreen();
+}
+
+bool TamaHost::publishFrame()
+{
+  LcdFrame frame;
+  _video.captureFrame(frame);
+  if (_frameQueue.push(frame))
+  {
+    _framesSent++;
+    return true;
+  }
+  _framesDropped++;
+  return false;
+}
+
+void TamaHost::logCoreLoad() const
+{
+  if (_dualCore)
+    Serial.printf("[Core] emulation %u%%, display %u%% (frames %lu sent, %lu dropped)\n", _emuLoad, displayLoad(),
+                  (unsigned long)_framesSent, (unsigned long)_framesDropped);
+  else
+    Serial.printf("[Core] emulation + display %u%%\n", _emuLoad);
 }
 
 // -------- HAL instance -> méthodes --------
 
 void TamaHost::handleUpdateScreen()
 {
-  _video.updateScreen();
+  // Trame refusée (file pleine) : republiée au prochain examen
+  if (_dualCore)
+    _screenPending = !publishFrame();
+  else
+  {
+    _video.updateScreen();
+    _screenPending = false;
+  }
 }
 
 void TamaHost::handleSetLcdMatrix(u8_t x, u8_t y, bool_t val)
 {
+  // Mode paresseux : cpu_step() a déjà écrit la mémoire d'affichage,
+  // VideoService la décodera à la prochaine trame
+  if (espgotchi_lcd_lazy)
+  {
+    espgotchi_lcd_dirty = 1;
+    return;
+  }
   _video.setLcdMatrix(x, y, val);
 }
 
 void TamaHost::handleSetLcdIcon(u8_t icon, bool_t val)
 {
+  if (espgotchi_lcd_lazy)
+  {
+    espgotchi_lcd_dirty = 1;
+    return;
+  }
   _video.setLcdIcon(icon, val);
 }
 
+void TamaHost::setLcdLazy(bool lazy)
+{
+  // Décode ce qui est en attente avant de repasser aux callbacks pixel par pixel
+  _video.syncLcd();
+  espgotchi_lcd_set_lazy(lazy ? 1 : 0);
+  Serial.printf("[TamaHost] LCD decoding: %s\n", lazy ? "lazy (per frame)" : "per pixel");
+}
+
 void TamaHost::handleSetFrequency(u32_t freq_dHz)
 {
   // TamaLIB envoie une fréquence en décis-Hz (dHz).
   // On convertit en Hz pour la couche audio ESP.
-  extern void espgotchi_hal_set_frequency(u32_t freqHz);
-
   u32_t freqHz = freq_dHz / 10; // 40960 dHz -> 4096 Hz, etc.
+  _audio.freqHz = freqHz;
+  if (_dualCore)
+  {
+    queueAudio();
+    return;
+  }
   espgotchi_hal_set_frequency(freqHz);
 }
 
 void TamaHost::handlePlayFrequency(bool_t en)
 {
-  extern void espgotchi_hal_play_frequency(bool_t en);
+  // Rattrapage : muet (l'état du buzzer est ré-émis à la fin)
+  if (_catchingUp)
+    return;
+  _audio.on = en;
+  if (_dualCore)
+  {
+    queueAudio();
+    return;
+  }
   espgotchi_hal_play_frequency(en);
 }
 
 int TamaHost::handleHandler()
 {
-  // 1) input -> hw_set_button()
-  _input.update();
+  // 1) input -> hw_set_button() (+ journal d'entrées, au tick de la transition)
+  //    Double cœur : un échantillon tactile reçu du cœur d'affichage par appel
+  InputSample in;
+  bool fresh = true;
+  if (_dualCore)
+  {
+    fresh = _inputQueue.pop(in);
+    if (_audioBacklog)
+      queueAudio();
+  }
+  else
+    in = _input.sample();
+  if (fresh)
+    _input.apply(in);
+  if (_inputLog.recording() && _input.buttons() != _inputLog.lastButtons() &&
+      !_inputLog.record(*cpu_get_state()->tick_counter, _input.buttons(), frameHash()))
+  {
+    Serial.println("[Input] log full");
+    stopInputRecording();
+  }
 
   // 2) bouton SPD (tap logique géré par InputService)
   if (_input.consumeTap(LogicalButton::SPEED))
@@ -189,10 +1190,14 @@ int TamaHost::handleHandler()
     uint8_t next =
         (timeMult == 1) ? 2 : (timeMult == 2) ? 4
                           : (timeMult == 4)   ? 8
+                          : (timeMult == 8)   ? TIME_MULT_MAX
                                               : 1;
 
     setTimeMult(next);
-    Serial.printf("[Time] Speed x%d\n", timeMult);
+    if (timeMult == TIME_MULT_MAX)
+      Serial.println("[Time] Speed MAX");
+    else
+      Serial.printf("[Time] Speed x%d\n", timeMult);
   }
 
   // 3) bouton debug au centre de l'écran
@@ -203,13 +1208,20 @@ int TamaHost::handleHandler()
     espgotchi_logical_state_t logicalState;
     espgotchi_read_logical_state(&logicalState);
     espgotchi_debug_dump_state(&logicalState);
+    printRewindStats();
+    printProfile();
   }
 
-  // 4) log HELD propre (on utilise maintenant LogicalButton)
-  LogicalButton held = _input.getHeld();
+  // 4) rewind : appui long sur la barre d'icônes = un instantané en arrière
+  if (_input.consumeTap(LogicalButton::REWIND))
+    rewind(1);
+  pollSerialCommands();
+
+  // 5) log HELD propre (on utilise maintenant LogicalButton)
+  LogicalButton held = in.held;
   uint8_t heldRaw = static_cast<uint8_t>(held);
 
-  if (heldRaw != _lastHeldLogged)
+  if (fresh && heldRaw != _lastHeldLogged)
   {
     _lastHeldLogged = heldRaw;
 
@@ -1,16 +1,92 @@
 #pragma once
 
 #include <Arduino.h>
+#include <atomic>
+#include "RewindRing.h"
+#include "InputRecorder.h"
+#include "SpscQueue.h"
+#include "VideoService.h"
+#include "InputService.h"
 
 extern "C"
 {
 #include "tamalib.h"
 #include "arduinogotchi_core/espgotchi_tamalib_ext.h"
+#include "arduinogotchi_core/espgotchi_cpu_fast.h"
+#include "arduinogotchi_core/espgotchi_sched.h"
+#include "arduinogotchi_core/espgotchi_savestate.h"
+#include "arduinogotchi_core/espgotchi_profile.h"
+#include "arduinogotchi_core/espgotchi_trace.h"
+#include "arduinogotchi_core/espgotchi_lcd.h"
 #include "hal.h"
 }
 
-class VideoService;
-class InputService;
+// Moteur CPU par défaut (surchargeable via build_flags) :
+// ESPGOTCHI_ENGINE_DECODED = programme pré-décodé + dispatch direct,
+// ESPGOTCHI_ENGINE_BLOCK   = blocs de base traduits + super-instructions,
+// ESPGOTCHI_ENGINE_TAMALIB = cpu_step() seul (référence).
+#ifndef ESPGOTCHI_CPU_ENGINE
+#define ESPGOTCHI_CPU_ENGINE ESPGOTCHI_ENGINE_DECODED
+#endif
+
+// Temps réel maximal consacré au rattrapage du boot (ms). La part de l'écart
+// que l'émulation exacte ne peut pas couvrir dans ce budget est appliquée
+// d'un coup à l'horloge du pet (voir TamaHost::catchUp())
+#ifndef ESPGOTCHI_CATCHUP_BUDGET_MS
+#define ESPGOTCHI_CATCHUP_BUDGET_MS 30000
+#endif
+
+// Rewind : un instantané toutes les ESPGOTCHI_REWIND_PERIOD_S secondes
+// émulées, deltas gardés dans ESPGOTCHI_REWIND_BYTES octets (PSRAM d’abord,
+// ~135 octets par point avec la ROM P1 : 32 Ko = ~40 min) et au plus
+// ESPGOTCHI_REWIND_ENTRIES points.
+// ESPGOTCHI_REWIND_BYTES = 0 : rewind désactivé.
+#ifndef ESPGOTCHI_REWIND_PERIOD_S
+#define ESPGOTCHI_REWIND_PERIOD_S 10
+#endif
+#ifndef ESPGOTCHI_REWIND_BYTES
+#define ESPGOTCHI_REWIND_BYTES 32768
+#endif
+#ifndef ESPGOTCHI_REWIND_ENTRIES
+#define ESPGOTCHI_REWIND_ENTRIES 1024
+#endif
+
+// Journal d'entrées : au plus ESPGOTCHI_INPUT_LOG_EVENTS transitions de
+// boutons par enregistrement (12 octets chacune, alloués au premier usage)
+#ifndef ESPGOTCHI_INPUT_LOG_EVENTS
+#define ESPGOTCHI_INPUT_LOG_EVENTS 1024
+#endif
+
+// Double cœur (ESP32) : l'émulation reste dans loop() (tâche Arduino,
+// cœur 1), affichage / tactile / son passent dans une tâche épinglée sur
+// ESPGOTCHI_UI_CORE (cœur 0, avec l'écrivain des checkpoints). 0 : tout
+// dans loop(), comme avant.
+#ifndef ESPGOTCHI_DUAL_CORE
+#define ESPGOTCHI_DUAL_CORE 1
+#endif
+#ifndef ESPGOTCHI_UI_CORE
+#define ESPGOTCHI_UI_CORE 0
+#endif
+#ifndef ESPGOTCHI_UI_TASK_STACK
+#define ESPGOTCHI_UI_TASK_STACK 6144
+#endif
+// Période de la boucle d'affichage (lecture tactile, files, rendu)
+#ifndef ESPGOTCHI_UI_POLL_MS
+#define ESPGOTCHI_UI_POLL_MS 5
+#endif
+
+// timeMult == TIME_MULT_MAX : mode MAX, TamaLIB tourne sans limitation
+// (cpu_set_speed(0)) et le rendu reste plafonné par RENDER_FPS.
+static constexpr uint8_t TIME_MULT_MAX = 0;
+
+// Bilan de TamaHost::catchUp() (tout à 0 : pas d'heure murale, rien fait)
+struct CatchUpResult
+{
+  uint32_t gapS;  // temps passé éteint
+  uint32_t doneS; // temps émulé exactement
+  uint32_t jumpS; // temps appliqué par saut d'horloge (doneS + jumpS < gapS : incomplet)
+  uint32_t ms;    // temps réel consacré
+};
 
 // Hôte TamaLIB : gère le HAL, la boucle d’émulation et le handler()
 class TamaHost
@@ -18,12 +94,111 @@ class TamaHost
 public:
   TamaHost(VideoService &video, InputService &input);
 
-  // displayFramerate = framerate logique (ex: 3), startTimestampUs = 1000000
+  // displayFramerate = framerate logique de TamaLIB (ex: 3 ; le rendu, lui,
+  // suit les changements de l'écran), startTimestampUs = 1000000
   void begin(uint8_t displayFramerate, uint32_t startTimestampUs);
 
   // À appeler dans loop()
   void loopOnce();
 
+  // Exécute au plus maxInstr instructions avec le moteur courant (rejeu
+  // d'entrées compris), sans cadence ni rendu. Retourne le nombre exécuté.
+  uint32_t runInstructions(uint32_t maxInstr);
+
+  // Fenêtre flash : émule d'avance us de temps réel (x1..x8, sans attente
+  // ni lecture des entrées), la loop n'aura donc rien à faire pendant ce
+  // temps. C'est là que l'écrivain des checkpoints efface ou programme :
+  // ESP-IDF gèle alors l'autre cœur et le cache flash, la cadence n'en
+  // prend pas de retard. Mode MAX : rien à avancer (pas d'échéance).
+  void runAhead(uint32_t us);
+
+  // Pire retard de l'émulation sur son échéance temps réel (µs) depuis
+  // le dernier appel, remis à 0 à la lecture
+  uint32_t takeWorstLateUs();
+
+  // Facteur de vitesse : 1, 2, 4, 8 ou TIME_MULT_MAX
+  void setTimeMult(uint8_t newMult);
+
+  // Nombre d'instructions exécutées depuis begin()
+  uint64_t stepCount() const { return _stepCount; }
+
+  // Ticks 32 kHz passés CPU arrêté (HALT/SLP) et sautés depuis begin()
+  uint64_t idleTicks() const { return _idleTicks; }
+
+  // Save-state : état CPU complet + matrice/icônes de VideoService.
+  // saveState() retourne la taille écrite (0 si buf trop petit, voir
+  // ESPGOTCHI_SAVESTATE_MAX_SIZE) ; loadState() ne touche à rien si invalide.
+  size_t saveState(uint8_t *buf, size_t cap);
+  bool loadState(const uint8_t *buf, size_t len);
+
+  // Rattrapage au boot : applique le temps réel écoulé depuis le save-state
+  // restauré (WallClock, si elle est réglée) en au plus budgetMs de temps
+  // réel, progression sur l'écran de splash. La ROM P1 ne s'arrête jamais
+  // (ni HALT ni SLP) : l'écart est émulé à vitesse MAX, sans rendu ni son,
+  // sauf la part que le budget ne couvre pas, sautée d'un coup sur
+  // l'horloge du pet (RAM P1) avant d'émuler la fin de l'écart. Le pet ne
+  // vieillit pas pendant ce saut. doneS + jumpS < gapS : incomplet.
+  CatchUpResult catchUp(uint32_t budgetMs = ESPGOTCHI_CATCHUP_BUDGET_MS);
+
+  // Rewind : revient steps instantanés en arrière (1 = le dernier pris).
+  // Commandes série : "rewind" (stats), "rewind N".
+  bool rewind(uint16_t steps);
+  void printRewindStats() const;
+
+  // Profileur (build avec -D ESPGOTCHI_PROFILE=1) : classes d'opcode et
+  // adresses ROM les plus exécutées depuis le dernier reset.
+  // Commandes série : "profile", "profile reset".
+  void printProfile() const;
+
+  // Trace (build avec -D ESPGOTCHI_TRACE=1) : les count dernières
+  // instructions désassemblées, ou tout l'anneau en hexadécimal (lignes
+  // "TR w0 w1", à décoder avec le natif : --decode-trace).
+  // Commandes série : "trace [N]", "trace stop", "trace start", "trace dump".
+  void printTrace(uint32_t count) const;
+  void dumpTrace() const;
+
+  // Journal d'entrées : transitions des boutons datées en temps émulé,
+  // rejouées au tick près depuis l'instantané de départ, à toute vitesse
+  // (MAX comprise), avec contrôle des empreintes LCD.
+  // Commandes série : "input" (état), "input rec", "input stop",
+  // "input replay", "input dump" (lignes "IR ...", rejouables en natif).
+  bool startInputRecording();
+  void stopInputRecording();
+  bool startInputReplay();
+  void stopInputReplay();
+  bool inputReplaying() const { return _inputLog.replaying(); }
+  const InputReplayStats &inputReplayStats() const { return _inputLog.replayStats(); }
+  bool loadInputRecording(const uint8_t *buf, size_t len);
+  size_t inputRecordingSize() const { return _inputLog.hasRecording() ? _inputLog.serializedSize() : 0; }
+  size_t saveInputRecording(uint8_t *buf, size_t cap) const;
+  void printInputLog() const;
+  void dumpInputLog() const;
+
+  // Moteur d'exécution CPU (voir ESPGOTCHI_CPU_ENGINE)
+  void setEngine(espgotchi_engine_t engine);
+  espgotchi_engine_t engine() const { return _engine; }
+
+  // Double cœur (voir ESPGOTCHI_DUAL_CORE) : à appeler une fois, après le
+  // rattrapage et avant la première loopOnce(). ESP32 : crée la tâche
+  // d'affichage ; natif : l'appelant fait tourner uiLoopOnce() dans un thread.
+  // Les deux côtés n'échangent que par files SPSC sans verrou : trames LCD
+  // et état du buzzer vers l'affichage, échantillons tactiles vers
+  // l'émulation. L'émulation n'attend jamais l'écran : trame perdue si la
+  // file est pleine (la suivante la remplace).
+  bool startDualCore();
+  bool dualCore() const { return _dualCore; }
+  void uiLoopOnce();
+
+  // Charge par cœur (% du temps réel hors attente, sur la dernière seconde),
+  // loggée toutes les 2 s ("[Core] ...")
+  uint8_t emulationLoad() const { return _emuLoad; }
+  uint8_t displayLoad() const { return _uiLoad.load(std::memory_order_relaxed); }
+
+  // Écran LCD : décodage de la mémoire d'affichage une fois par trame
+  // (défaut, voir ESPGOTCHI_LCD_LAZY) ou callbacks HAL pixel par pixel
+  void setLcdLazy(bool lazy);
+  bool lcdLazy() const { return espgotchi_lcd_lazy; }
+
 private:
   VideoService &_video;
   InputService &_input;
@@ -35,10 +210,102 @@ private:
   uint8_t _lastHeldLogged = 0;
 
   u32_t _tamaTsFreq;               // fréquence de référence passée à tamalib_init_* (ex: 1_000_000 pour us)
-  timestamp_t _lastScreenUpdateTs; // dernier timestamp où l’on a rafraîchi l’écran
+
+  // publication de l'écran sur changement (voir pollScreen())
+  uint32_t _screenPollMs = 0;     // dernier examen de l'écran émulé
+  uint32_t _screenRevision = 0;   // VideoService::screenRevision() à cet examen
+  uint32_t _screenChangeMs = 0;   // premier changement pas encore publié
+  uint32_t _screenPublishMs = 0;  // dernière trame publiée
+  bool _screenPending = false;
+
+  // mesure de la vitesse réellement atteinte (temps émulé / temps réel)
+  uint64_t _stepCount = 0;
+  uint64_t _speedSampleSteps = 0;
+  uint64_t _idleTicks = 0;
+  uint64_t _speedSampleIdleTicks = 0;
+  u32_t _speedSampleTicks = 0;
+  uint32_t _speedSampleMs = 0;
+
+  // horloge murale (epoch, s) du save-state restauré, 0 si inconnue
+  uint32_t _savedWallClock = 0;
+  bool _catchingUp = false;
+
+  uint32_t planClockJump(uint64_t leftTicks, uint64_t probeTicks, int64_t probeUs, int64_t budgetUs,
+                         bool clockValid, u32_t probeClock);
+
+  // rewind
+  RewindRing _rewind;
+  u32_t _rewindTick = 0;                           // tick du dernier instantané
+  uint8_t _snapBuf[ESPGOTCHI_SAVESTATE_MAX_SIZE];  // instantané courant
+  char _serialLine[24];
+  uint8_t _serialLen = 0;
+
+  void beginRewind();
+  void updateRewind();
+  void pollSerialCommands();
+
+  // journal d'entrées
+  InputRecorder _inputLog;
+
+  bool beginInputLog();
+  bool restoreExact(const uint8_t *snap, size_t len);
+  uint32_t frameHash() const;
+  u32_t stepInputReplay(u32_t maxInstr);
+  void finishInputReplay();
+
+  // moteur CPU + cadence côté hôte (moteurs décodé/blocs : TamaLIB en speed 0)
+  espgotchi_engine_t _engine = (espgotchi_engine_t)ESPGOTCHI_CPU_ENGINE;
+  u32_t _throttleTicks = 0;    // tick_counter de référence
+  timestamp_t _throttleTs = 0; // instant réel correspondant
+
+  uint32_t executeSlice();
+  void throttleToTicks();
+  void resyncThrottle();
+  static const char *engineName(espgotchi_engine_t engine);
+
+  void runMaxBurst();
+  void updateSpeedStats(uint32_t nowMs);
+
+  // double cœur : état du buzzer (le dernier compte, pas chaque événement)
+  struct AudioState
+  {
+    u32_t freqHz;
+    bool_t on;
+  };
+
+  bool _dualCore = false;
+  SpscQueue<LcdFrame, 4> _frameQueue;     // émulation -> affichage
+  SpscQueue<AudioState, 16> _audioQueue;  // émulation -> affichage
+  SpscQueue<InputSample, 16> _inputQueue; // affichage -> émulation
+
+  // côté émulation
+  AudioState _audio = {0, 0};
+  bool _audioBacklog = false; // état du buzzer pas encore transmis (file pleine)
+  uint32_t _framesSent = 0;
+  uint32_t _framesDropped = 0;
+  uint64_t _sleptUs = 0; // temps passé dans sleepUntil()
+  uint32_t _worstLateUs = 0; // pire échéance manquée par sleepUntil()
+  bool _runningAhead = false; // runAhead() : sleepUntil() ne dort pas
+  uint64_t _loadSampleSleptUs = 0;
+  uint8_t _emuLoad = 0;
+
+  // côté affichage
+  InputSample _uiSent = {0, 0, LogicalButton::NONE};
+  uint8_t _uiTaps = 0; // taps pas encore transmis (file pleine)
+  AudioState _uiAudio = {0, 0};
+  uint64_t _uiBusyUs = 0;
+  int64_t _uiLoadStartUs = 0;
+  std::atomic<uint8_t> _uiLoad{0};
+
+  void queueAudio();
+  void pollScreen();
+  bool publishFrame();
+  void logCoreLoad() const;
+#ifndef ESPGOTCHI_NATIVE
+  static void uiTask(void *arg);
+#endif
 
   // time scaling
-  void setTimeMult(uint8_t newMult);
   timestamp_t getTimestamp();
   void sleepUntil(timestamp_t ts);
 
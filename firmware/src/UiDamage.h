@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+
+// Zone écran [x0, x1) x [y0, y1), vide si x0 >= x1 ou y0 >= y1
+struct ScreenRect
+{
+  int16_t x0, y0, x1, y1;
+
+  bool empty() const { return x0 >= x1 || y0 >= y1; }
+  int32_t area() const { return empty() ? 0 : (int32_t)(x1 - x0) * (y1 - y0); }
+
+  bool intersects(const ScreenRect &o) const
+  {
+    return x0 < o.x1 && o.x0 < x1 && y0 < o.y1 && o.y0 < y1;
+  }
+
+  bool contains(const ScreenRect &o) const
+  {
+    return o.x0 >= x0 && o.x1 <= x1 && o.y0 >= y0 && o.y1 <= y1;
+  }
+
+  ScreenRect clip(const ScreenRect &o) const
+  {
+    return {x0 > o.x0 ? x0 : o.x0, y0 > o.y0 ? y0 : o.y0, x1 < o.x1 ? x1 : o.x1, y1 < o.y1 ? y1 : o.y1};
+  }
+
+  ScreenRect unite(const ScreenRect &o) const
+  {
+    return {x0 < o.x0 ? x0 : o.x0, y0 < o.y0 ? y0 : o.y0, x1 > o.x1 ? x1 : o.x1, y1 > o.y1 ? y1 : o.y1};
+  }
+};
+
+static inline ScreenRect screenRect(int x, int y, int w, int h)
+{
+  return {(int16_t)x, (int16_t)y, (int16_t)(x + w), (int16_t)(y + h)};
+}
+
+// Zones endommagées d'une trame, au plus N rectangles. Au-delà, le nouveau
+// est fusionné avec celui dont l'union grossit le moins : la zone repeinte
+// peut grandir, jamais rétrécir.
+template <uint8_t N>
+class DamageList
+{
+public:
+  void add(const ScreenRect &r)
+  {
+    if (r.empty())
+      return;
+    uint8_t best = 0;
+    int32_t bestGrowth = INT32_MAX;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+      if (_rects[i].contains(r))
+        return;
+      const int32_t growth = _rects[i].unite(r).area() - _rects[i].area();
+      if (growth < bestGrowth)
+      {
+        best = i;
+        bestGrowth = growth;
+      }
+    }
+    if (_count < N)
+      _rects[_count++] = r;
+    else
+      _rects[best] = _rects[best].unite(r);
+  }
+
+  void clear() { _count = 0; }
+
+  bool intersects(const ScreenRect &area) const
+  {
+    for (uint8_t i = 0; i < _count; i++)
+    {
+      if (_rects[i].intersects(area))
+        return true;
+    }
+    return false;
+  }
+
+  // Les dommages qui touchent area restent-ils tous dans inner ?
+  bool within(const ScreenRect &area, const ScreenRect &inner) const
+  {
+    for (uint8_t i = 0; i < _count; i++)
+    {
+      if (_rects[i].intersects(area) && !inner.contains(_rects[i].clip(area)))
+        return false;
+    }
+    return true;
+  }
+
+  uint8_t count() const { return _count; }
+  const ScreenRect &operator[](uint8_t i) const { return _rects[i]; }
+
+private:
+  ScreenRect _rects[N];
+  uint8_t _count = 0;
+};
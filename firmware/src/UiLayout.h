@@ -17,4 +17,6 @@ static constexpr uint16_t SPEED_BTN_H = TOP_BAR_H;
 static constexpr uint16_t SPEED_BTN_X = SCREEN_W - SPEED_BTN_W;
 static constexpr uint16_t SPEED_BTN_Y = 0;
 
+// Cadence de rendu en mode MAX et des pas de la rémanence (sinon : rendu sur
+// changement, voir ESPGOTCHI_RENDER_MIN_INTERVAL_MS)
 static constexpr uint32_t RENDER_FPS = 4;
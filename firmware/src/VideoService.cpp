@@ -1,6 +1,8 @@
 #include "VideoService.h"
 #include "InputService.h"
+#include "TamaHost.h"
 #include "esp_timer.h"
+#include <esp_heap_caps.h>
 
 extern "C"
 {
@@ -12,12 +14,96 @@ static constexpr uint16_t LCD_COLOR_BG = TFT_LIGHTGREY;
 static constexpr uint16_t LCD_COLOR_PIXEL = TFT_BLACK;
 static constexpr uint16_t LCD_COLOR_FRAME = TFT_DARKGREY;
 
-// timeMult est défini dans TamaHost (facteur de vitesse / affichage SPD)
+// Mélange RGB565 : a vers b, num / den
+static constexpr uint16_t mix565(uint16_t a, uint16_t b, int num, int den)
+{
+  return (uint16_t)(((((a >> 11) * (den - num) + (b >> 11) * num) / den) << 11) |
+                    (((((a >> 5) & 0x3F) * (den - num) + ((b >> 5) & 0x3F) * num) / den) << 5) |
+                    (((a & 0x1F) * (den - num) + (b & 0x1F) * num) / den));
+}
+
+// Couleur de chaque niveau de pixel (rémanence) : fond, deux gris, pixel
+static constexpr uint16_t LCD_SHADES[4] = {
+    LCD_COLOR_BG,
+    mix565(LCD_COLOR_BG, LCD_COLOR_PIXEL, 1, 3),
+    mix565(LCD_COLOR_BG, LCD_COLOR_PIXEL, 2, 3),
+    LCD_COLOR_PIXEL,
+};
+
+// Niveau (0..3) du pixel x d'une ligne, depuis ses deux plans
+static inline int shadeAt(uint32_t hi, uint32_t lo, int x)
+{
+  return (int)(((hi << x) >> 30) & 0x2) | (int)((lo << x) >> 31);
+}
+
+// Barre d'icônes : ICON_NUM slots, bitmaps 16x9 agrandis x2 et centrés ;
+// une tuile couvre un slot, sans la ligne de séparation du bas
+static constexpr int ICON_BMP_W = 16;
+static constexpr int ICON_BMP_H = 9;
+static constexpr int ICON_SCALE = 2;
+static constexpr int ICON_SLOT_W = (SCREEN_W - SPEED_BTN_W) / ICON_NUM;
+static constexpr int ICON_TILE_H = TOP_BAR_H - 1;
+static constexpr int ICON_TILE_PX = ICON_SLOT_W * ICON_TILE_H;
+
+// Widgets du compositeur : zones fixes qui pavent l'écran
+static constexpr int BUTTONS_Y = SCREEN_H - BOTTOM_BAR_H;
+static constexpr int BUTTON_COUNT = 4;
+static constexpr int BUTTON_SLOT_W = SCREEN_W / BUTTON_COUNT;
+static const ScreenRect ICONS_AREA = screenRect(0, 0, SCREEN_W - SPEED_BTN_W, TOP_BAR_H);
+static const ScreenRect SPEED_AREA = screenRect(SPEED_BTN_X, SPEED_BTN_Y, SPEED_BTN_W, SPEED_BTN_H);
+static const ScreenRect LCD_AREA = screenRect(0, TOP_BAR_H, SCREEN_W, BUTTONS_Y - TOP_BAR_H);
+static const ScreenRect BUTTONS_AREA = screenRect(0, BUTTONS_Y, SCREEN_W, BOTTOM_BAR_H);
+
+// RGB565 dans l'ordre des octets du bus (setSwapBytes(false) : pushImage()
+// et le DMA envoient la mémoire telle quelle, poids fort attendu d'abord)
+static inline uint16_t busOrder(uint16_t color)
+{
+  return (uint16_t)((color >> 8) | (color << 8));
+}
+
+// Pixel (i, j) d'un bitmap 16x9 (LSB first, ligne par ligne)
+static inline bool iconBit(const uint8_t *data, int i, int j)
+{
+  const int bitIndex = j * ICON_BMP_W + i;
+  return (data[bitIndex / 8] >> (bitIndex % 8)) & 0x01;
+}
+
+// Décalage horizontal qui centre les colonnes réellement utilisées
+static int iconOffsetX(const uint8_t *data)
+{
+  int minCol = ICON_BMP_W;
+  int maxCol = -1;
+
+  for (int j = 0; j < ICON_BMP_H; j++)
+  {
+    for (int i = 0; i < ICON_BMP_W; i++)
+    {
+      if (iconBit(data, i, j))
+      {
+        if (i < minCol)
+          minCol = i;
+        if (i > maxCol)
+          maxCol = i;
+      }
+    }
+  }
+
+  // Décalage = centrer activeWidth dans w, puis compenser minCol
+  if (maxCol < minCol)
+    return 0;
+  return (ICON_BMP_W - (maxCol - minCol + 1)) / 2 - minCol;
+}
+
+// timeMult est défini dans TamaHost (facteur de vitesse / affichage SPD),
+// lu seulement par captureFrame() et screenRevision()
 extern uint8_t timeMult;
+// Vitesse mesurée par TamaHost, affichée en mode MAX
+extern uint16_t achievedSpeed;
 
 VideoService::VideoService()
     : _tft()
 {
+  invalidate();
 }
 
 void VideoService::initDisplay()
@@ -36,38 +122,165 @@ void VideoService::initDisplay()
   digitalWrite(TFT_BL, HIGH);
 #endif
 #endif
+
+  beginLcdDma();
+  buildIconTiles();
+}
+
+uint16_t *VideoService::iconTile(int icon, bool selected) const
+{
+  return _iconTiles + (icon * 2 + (selected ? 1 : 0)) * ICON_TILE_PX;
+}
+
+void VideoService::buildIconTiles()
+{
+  // Même politique que TamaHost::hal_malloc() : PSRAM si dispo, sinon heap
+  // (pushImage() sans DMA peut lire la PSRAM)
+  const size_t bytes = (size_t)ICON_NUM * 2 * ICON_TILE_PX * sizeof(uint16_t);
+  if (!_iconTiles)
+    _iconTiles = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!_iconTiles)
+    _iconTiles = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_DEFAULT);
+  if (!_iconTiles)
+  {
+    Serial.println("[Video] icon cache: off (allocation failed)");
+    return;
+  }
+
+  const int x0 = (ICON_SLOT_W - ICON_BMP_W * ICON_SCALE) / 2;
+  const int y0 = (TOP_BAR_H - ICON_BMP_H * ICON_SCALE) / 2;
+  const uint16_t fg = busOrder(TFT_WHITE);
+
+  for (int i = 0; i < ICON_NUM; i++)
+  {
+    const uint8_t *data = bitmaps + (i * 18);
+    const int offsetX = iconOffsetX(data);
+
+    for (int selected = 0; selected < 2; selected++)
+    {
+      uint16_t *tile = iconTile(i, selected);
+      const uint16_t bg = busOrder(selected ? TFT_DARKGREY : TFT_BLACK);
+      for (int k = 0; k < ICON_TILE_PX; k++)
+        tile[k] = bg;
+
+      for (int j = 0; j < ICON_BMP_H; j++)
+      {
+        for (int b = 0; b < ICON_BMP_W; b++)
+        {
+          if (!iconBit(data, b, j))
+            continue;
+          const int px = x0 + (b + offsetX) * ICON_SCALE;
+          const int py = y0 + j * ICON_SCALE;
+          for (int dy = 0; dy < ICON_SCALE; dy++)
+          {
+            for (int dx = 0; dx < ICON_SCALE; dx++)
+            {
+              if (px + dx >= 0 && px + dx < ICON_SLOT_W && py + dy < ICON_TILE_H)
+                tile[(py + dy) * ICON_SLOT_W + px + dx] = fg;
+            }
+          }
+        }
+      }
+    }
+  }
+  Serial.printf("[Video] icon cache: %d tiles, %u bytes\n", ICON_NUM * 2, (unsigned)bytes);
+}
+
+void VideoService::beginLcdDma()
+{
+#if ESPGOTCHI_LCD_DMA
+  // Le DMA SPI de l'ESP32 ne lit pas la PSRAM : RAM interne obligatoire
+  // (2 x ~5 Ko pour une ligne LCD agrandie x9)
+  int offX, offY, scale;
+  lcdArea(offX, offY, scale);
+  const size_t bytes = (size_t)LCD_WIDTH * scale * scale * sizeof(uint16_t);
+  for (int i = 0; i < 2; i++)
+  {
+    if (!_dmaBuf[i])
+      _dmaBuf[i] = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  }
+  _dmaReady = _dmaBuf[0] && _dmaBuf[1] && _tft.initDMA();
+  Serial.printf("[Video] LCD DMA: %s (2 x %u bytes)\n", _dmaReady ? "on" : "off", (unsigned)bytes);
+#endif
+}
+
+void VideoService::finishLcdDma()
+{
+  // Avant toute autre écriture TFT : fin du dernier transfert de la zone LCD
+  if (!_dmaPending)
+    return;
+  _tft.dmaWait();
+  _tft.endWrite();
+  _dmaPending = false;
 }
 
 void VideoService::begin()
 {
-  memset(_matrix, 0, sizeof(_matrix));
-  memset(_prevMatrix, 0, sizeof(_prevMatrix)); // NEW
+  memset(_lcdMatrix, 0, sizeof(_lcdMatrix));
+  memset(_lcdIcons, 0, sizeof(_lcdIcons));
+  memset(_matrixRows, 0, sizeof(_matrixRows));
+  memset(_shadeHi, 0, sizeof(_shadeHi));
+  memset(_shadeLo, 0, sizeof(_shadeLo));
+  clearDrawnShades();
+  _shadesSettled = true;
   memset(_icons, 0, sizeof(_icons));
   _lastRenderRealUs = 0;
-  _lastMatrixHash = 0;
-  _firstMatrixRender = true; // NEW
+  _framePending = false;
+  _lcdFullRedraw = true;
+
+  memset(_drawnIcons, 0, sizeof(_drawnIcons));
+  _drawnTimeMult = 0;
+  _drawnSpeed = 0;
+  _drawnHeld = LogicalButton::NONE;
+  invalidate();
 }
 
 void VideoService::clearScreen()
 {
+  finishLcdDma();
   _tft.fillScreen(TFT_BLACK);
+  invalidate();
 }
 
 void VideoService::showSplash(const char *text)
 {
+  finishLcdDma();
   _tft.setTextColor(TFT_GREEN, TFT_BLACK);
   _tft.setTextSize(1);
   _tft.setCursor(10, 35);
   _tft.println(text);
+  invalidateRect(10, 35, (int)strlen(text) * 6, 8);
+}
+
+void VideoService::showProgress(const char *label, uint8_t pct)
+{
+  const int x = 10;
+  const int w = SCREEN_W - 2 * x;
+  const int barY = 70;
+  const int barH = 10;
+
+  if (pct > 100)
+    pct = 100;
+  finishLcdDma();
+
+  _tft.setTextColor(TFT_GREEN, TFT_BLACK);
+  _tft.setTextSize(1);
+  _tft.setCursor(x, 55);
+  _tft.printf("%s %3u%%", label, pct);
+
+  _tft.drawRect(x, barY, w, barH, TFT_DARKGREY);
+  _tft.fillRect(x + 1, barY + 1, (w - 2) * pct / 100, barH - 2, TFT_GREEN);
+  invalidateRect(x, 55, w, barY + barH - 55);
 }
 
 void VideoService::setLcdMatrix(u8_t x, u8_t y, bool_t val)
 {
+  const bool_t was = _lcdMatrix[y][x / 8];
   uint8_t mask;
   if (val)
   {
     mask = 0b10000000 >> (x % 8);
-    _matrix[y][x / 8] = _matrix[y][x / 8] | mask;
+    _lcdMatrix[y][x / 8] = _lcdMatrix[y][x / 8] | mask;
   }
   else
   {
@@ -76,49 +289,125 @@ void VideoService::setLcdMatrix(u8_t x, u8_t y, bool_t val)
     {
       mask = (mask >> 1) | 0b10000000;
     }
-    _matrix[y][x / 8] = _matrix[y][x / 8] & mask;
+    _lcdMatrix[y][x / 8] = _lcdMatrix[y][x / 8] & mask;
   }
+  if (_lcdMatrix[y][x / 8] != was)
+    _lcdRevision++;
 }
 
 void VideoService::setLcdIcon(u8_t icon, bool_t val)
 {
-  if (icon < ICON_NUM)
+  if (icon < ICON_NUM && _lcdIcons[icon] != val)
   {
-    _icons[icon] = val;
+    _lcdIcons[icon] = val;
+    _lcdRevision++;
   }
 }
 
-void VideoService::setInputService(InputService *input)
+void VideoService::syncLcd()
 {
-  _input = input;
+  if (!espgotchi_lcd_take_dirty())
+    return;
+
+  // Le ROM réécrit souvent la même chose : ne compte que les vrais changements
+  bool_t matrix[LCD_HEIGHT][LCD_WIDTH / 8];
+  bool_t icons[ICON_NUM];
+  memcpy(matrix, _lcdMatrix, sizeof(matrix));
+  memcpy(icons, _lcdIcons, sizeof(icons));
+  espgotchi_lcd_decode(_lcdMatrix, _lcdIcons);
+  if (memcmp(matrix, _lcdMatrix, sizeof(matrix)) != 0 || memcmp(icons, _lcdIcons, sizeof(icons)) != 0)
+    _lcdRevision++;
 }
 
-uint32_t VideoService::hashMatrix() const
+size_t VideoService::exportState(uint8_t *out, size_t cap)
 {
-  uint32_t h = 2166136261u;
+  if (cap < STATE_SIZE)
+    return 0;
+
+  syncLcd();
+
+  size_t n = 0;
   for (int y = 0; y < LCD_HEIGHT; y++)
   {
     for (int b = 0; b < LCD_WIDTH / 8; b++)
-    {
-      h ^= (uint8_t)_matrix[y][b];
-      h *= 16777619u;
-    }
+      out[n++] = (uint8_t)_lcdMatrix[y][b];
   }
-  return h;
+  for (int i = 0; i < ICON_NUM; i++)
+    out[n++] = _lcdIcons[i] ? 1 : 0;
+  return n;
 }
 
-void VideoService::renderMatrixToTft()
+bool VideoService::importState(const uint8_t *in, size_t len)
 {
-  // Hash pour éviter de traiter si rien n'a changé
-  uint32_t h = hashMatrix();
+  if (len != STATE_SIZE)
+    return false;
 
-  if (!_firstMatrixRender && h == _lastMatrixHash)
+  size_t n = 0;
+  for (int y = 0; y < LCD_HEIGHT; y++)
   {
-    // Matrice identique à la dernière frame → rien à faire
-    return;
+    for (int b = 0; b < LCD_WIDTH / 8; b++)
+      _lcdMatrix[y][b] = in[n++];
+  }
+  for (int i = 0; i < ICON_NUM; i++)
+    _lcdIcons[i] = in[n++] ? 1 : 0;
+
+  // Redessin complet à la prochaine trame présentée (le TFT montre encore
+  // l'ancien état)
+  _lcdGeneration++;
+  _lcdRevision++;
+  return true;
+}
+
+void VideoService::setInputService(InputService *input)
+{
+  _input = input;
+}
+
+bool VideoService::matrixUnchanged() const
+{
+  // Niveaux stables et pas de redessin complet : à l'écran, hi = lo = la
+  // trame du dernier rendu. Une comparaison par ligne.
+  for (int y = 0; y < LCD_HEIGHT; y++)
+  {
+    if (_matrixRows[y] != _drawnHi[y])
+      return false;
   }
-  _lastMatrixHash = h;
+  return true;
+}
 
+void VideoService::diffShades(LcdDiff &diff) const
+{
+  // XOR des plans ligne par ligne, puis seuls les bits à 1 sont parcourus :
+  // le pixel x est sur le bit 31 - x, clz donne le début d'une suite et
+  // clz du complément sa longueur
+  diff.rowCount = 0;
+  uint16_t spanCount = 0;
+  for (int y = 0; y < LCD_HEIGHT; y++)
+  {
+    uint32_t changed = (_shadeHi[y] ^ _drawnHi[y]) | (_shadeLo[y] ^ _drawnLo[y]);
+    if (!changed)
+      continue;
+
+    diff.rows[diff.rowCount] = (uint8_t)y;
+    diff.firstSpan[diff.rowCount] = spanCount;
+    diff.rowCount++;
+    uint8_t x = 0;
+    while (changed)
+    {
+      const uint8_t skip = (uint8_t)__builtin_clz(changed);
+      changed <<= skip;
+      const uint8_t len = ~changed ? (uint8_t)__builtin_clz(~changed) : 32;
+      x += skip;
+      diff.spans[spanCount++] = {x, (uint8_t)(x + len)};
+      x += len;
+      changed = len < 32 ? changed << len : 0;
+    }
+  }
+  diff.firstSpan[diff.rowCount] = spanCount;
+}
+
+void VideoService::lcdArea(int &offX, int &offY, int &scale) const
+{
   const int margin = 8;
 
   int availX = margin;
@@ -128,18 +417,32 @@ void VideoService::renderMatrixToTft()
 
   int scaleX = availW / LCD_WIDTH;
   int scaleY = availH / LCD_HEIGHT;
-  int scale = min(scaleX, scaleY);
+  scale = min(scaleX, scaleY);
   if (scale < 1)
     scale = 1;
 
-  int drawW = LCD_WIDTH * scale;
-  int drawH = LCD_HEIGHT * scale;
+  offX = availX + (availW - LCD_WIDTH * scale) / 2;
+  offY = availY + (availH - LCD_HEIGHT * scale) / 2;
+}
+
+void VideoService::renderMatrixToTft()
+{
+  if (!_lcdFullRedraw && _shadesSettled && matrixUnchanged())
+  {
+    // Matrice identique à la dernière frame, niveaux stables → rien à faire
+    return;
+  }
+  updateShades();
+
+  int offX, offY, scale;
+  lcdArea(offX, offY, scale);
+  const int drawW = LCD_WIDTH * scale;
+  const int drawH = LCD_HEIGHT * scale;
 
-  int offX = availX + (availW - drawW) / 2;
-  int offY = availY + (availH - drawH) / 2;
+  finishLcdDma();
 
-  // Au tout premier rendu : on dessine le cadre + le fond LCD complet
-  if (_firstMatrixRender)
+  // Premier rendu ou zone endommagée : cadre + fond LCD complet
+  if (_lcdFullRedraw)
   {
     // Cadre autour de l'écran LCD
     _tft.fillRect(offX - 2, offY - 2, drawW + 4, drawH + 4, LCD_COLOR_FRAME);
@@ -147,84 +450,216 @@ void VideoService::renderMatrixToTft()
     // Fond LCD (pixels "éteints")
     _tft.fillRect(offX, offY, drawW, drawH, LCD_COLOR_BG);
 
-    _firstMatrixRender = false;
+    _lcdFullRedraw = false;
   }
 
-  // Mise à jour pixel par pixel uniquement si changement par rapport à _prevMatrix
-  for (int y = 0; y < LCD_HEIGHT; y++)
+  // Pixels dont le niveau a changé depuis _drawn*, regroupés en rectangles :
+  // suites horizontales de pixels modifiés, prolongées sur les lignes
+  // suivantes tant que la suite couvre les mêmes colonnes. Un rectangle =
+  // une fenêtre d'adressage + une rafale de couleurs (au lieu d'un fillRect
+  // par pixel). Seules les lignes modifiées sont parcourues.
+  LcdDiff diff;
+  diffShades(diff);
+
+  LcdRect pending[LCD_WIDTH / 2];
+  uint8_t pendingCount = 0;
+  int prevY = -1;
+
+  _tft.startWrite();
+  for (uint8_t i = 0; i <= diff.rowCount; i++)
   {
-    for (int x = 0; x < LCD_WIDTH; x++)
+    // Ligne modifiée suivante (aucune après la dernière : tout est fermé) ;
+    // une ligne inchangée entre deux ferme aussi tous les rectangles ouverts
+    const bool last = i == diff.rowCount;
+    const int y = last ? LCD_HEIGHT : diff.rows[i];
+    if (last || y != prevY + 1)
     {
-      uint8_t mask = 0b10000000 >> (x % 8);
+      for (uint8_t k = 0; k < pendingCount; k++)
+        drawLcdRect(pending[k], offX, offY, scale);
+      pendingCount = 0;
+    }
+    if (last)
+      break;
+    prevY = y;
 
-      bool curOn = (_matrix[y][x / 8] & mask) != 0;
-      bool prevOn = (_prevMatrix[y][x / 8] & mask) != 0;
+    const LcdSpan *runs = &diff.spans[diff.firstSpan[i]];
+    const uint8_t runCount = (uint8_t)(diff.firstSpan[i + 1] - diff.firstSpan[i]);
 
-      // Pas de changement → on ne touche pas au TFT
-      if (curOn == prevOn)
-        continue;
+    // Rectangles ouverts : prolongés par une suite identique, sinon dessinés
+    bool used[LCD_WIDTH / 2] = {};
+    uint8_t kept = 0;
+    for (uint8_t k = 0; k < pendingCount; k++)
+    {
+      LcdRect r = pending[k];
+      uint8_t j = 0;
+      while (j < runCount && (used[j] || runs[j].x0 != r.x0 || runs[j].x1 != r.x1))
+        j++;
+      if (j < runCount)
+      {
+        used[j] = true;
+        r.y1 = (uint8_t)(y + 1);
+        pending[kept++] = r;
+      }
+      else
+      {
+        drawLcdRect(r, offX, offY, scale);
+      }
+    }
+    for (uint8_t j = 0; j < runCount; j++)
+    {
+      if (!used[j])
+        pending[kept++] = {runs[j].x0, runs[j].x1, (uint8_t)y, (uint8_t)(y + 1)};
+    }
+    pendingCount = kept;
+  }
 
-      int px = offX + x * scale;
-      int py = offY + y * scale;
+  // DMA : la transaction reste ouverte et le dernier transfert se termine
+  // pendant l'émulation ; finishLcdDma() le clôt avant la prochaine écriture
+  if (!_dmaPending)
+    _tft.endWrite();
 
-      uint16_t color = curOn ? LCD_COLOR_PIXEL : LCD_COLOR_BG;
+  // Sauvegarde de l'état courant pour la prochaine frame
+  memcpy(_drawnHi, _shadeHi, sizeof(_drawnHi));
+  memcpy(_drawnLo, _shadeLo, sizeof(_drawnLo));
+}
 
-      _tft.fillRect(px, py, scale, scale, color);
+void VideoService::updateShades()
+{
+  // Un pas de rémanence par rendu, 32 pixels à la fois : allumés +2 saturé
+  // à 3 (0 -> 2, 1/2 -> 3), éteints -1 saturé à 0. Un redessin complet
+  // (premier rendu, état importé, zone LCD endommagée) repart des pixels
+  // tels quels.
+  bool settled = true;
+  for (int y = 0; y < LCD_HEIGHT; y++)
+  {
+    const uint32_t on = _matrixRows[y];
+    if (!_ghosting || _lcdFullRedraw)
+    {
+      _shadeHi[y] = on;
+      _shadeLo[y] = on;
+      continue;
     }
+    const uint32_t hi = _shadeHi[y];
+    const uint32_t lo = _shadeLo[y];
+    const uint32_t fading = ~on & (hi | lo);
+    _shadeLo[y] = (lo | (on & hi)) ^ fading;
+    _shadeHi[y] = (hi | on) ^ (fading & ~lo);
+    settled &= _shadeHi[y] == on && _shadeLo[y] == on;
   }
+  _shadesSettled = settled;
+}
 
-  // Sauvegarde de l'état courant pour la prochaine frame
-  memcpy(_prevMatrix, _matrix, sizeof(_matrix));
+void VideoService::clearDrawnShades()
+{
+  memset(_drawnHi, 0, sizeof(_drawnHi));
+  memset(_drawnLo, 0, sizeof(_drawnLo));
 }
 
-void VideoService::drawMonoBitmap16x9(int x, int y, const uint8_t *data, int scale)
+void VideoService::setGhosting(bool on)
 {
-  const int w = 16;
-  const int h = 9;
+  _ghosting = on;
+  // Prochain rendu : un pas depuis les niveaux actuels, même écran inchangé
+  _shadesSettled = false;
+}
 
-  // 1) On cherche les colonnes réellement utilisées (où au moins un pixel est à 1)
-  int minCol = w;
-  int maxCol = -1;
+uint32_t VideoService::rowBits(const bool_t matrix[LCD_HEIGHT][LCD_WIDTH / 8], int y)
+{
+  // Pixel x sur le bit 31 - x (MSB = x == 0, comme dans la matrice)
+  return ((uint32_t)matrix[y][0] << 24) | ((uint32_t)matrix[y][1] << 16) | ((uint32_t)matrix[y][2] << 8) |
+         (uint32_t)matrix[y][3];
+}
 
-  for (int j = 0; j < h; j++)
+void VideoService::drawLcdRect(const LcdRect &r, int offX, int offY, int scale)
+{
+  const int px = offX + r.x0 * scale;
+  const int py = offY + r.y0 * scale;
+  const int w = (r.x1 - r.x0) * scale;
+  const int h = (r.y1 - r.y0) * scale;
+
+  if (_dmaReady)
   {
-    for (int i = 0; i < w; i++)
-    {
-      int bitIndex = j * w + i;
-      int byteIndex = bitIndex / 8;
-      int bitInByte = bitIndex % 8;
+    pushLcdRectDma(r, px, py, w, h, scale);
+    return;
+  }
 
-      bool on = (data[byteIndex] >> bitInByte) & 0x01;
-      if (on)
-      {
-        if (i < minCol)
-          minCol = i;
-        if (i > maxCol)
-          maxCol = i;
-      }
-    }
+  // Colonnes x0..x1-1 du rectangle
+  const uint32_t cols = (0xFFFFFFFFu >> r.x0) & ~(r.x1 < 32 ? 0xFFFFFFFFu >> r.x1 : 0u);
+  uint32_t anyHi = 0, allHi = cols, anyLo = 0, allLo = cols;
+  for (int y = r.y0; y < r.y1; y++)
+  {
+    anyHi |= _shadeHi[y] & cols;
+    allHi &= _shadeHi[y];
+    anyLo |= _shadeLo[y] & cols;
+    allLo &= _shadeLo[y];
+  }
+
+  // Rectangle uni (chaque plan tout à 0 ou tout à 1) : fillRect, une
+  // fenêtre + une rafale de la même couleur
+  if ((anyHi == 0 || allHi == cols) && (anyLo == 0 || allLo == cols))
+  {
+    _tft.fillRect(px, py, w, h, LCD_SHADES[(anyHi ? 2 : 0) | (anyLo ? 1 : 0)]);
+    return;
   }
 
-  // 2) Calcul du décalage horizontal pour centrer la "vraie" largeur
-  int offsetX = 0;
-  if (maxCol >= minCol)
+  // Sinon une fenêtre, puis chaque ligne LCD poussée `scale` fois
+  _tft.setAddrWindow(px, py, w, h);
+  for (int y = r.y0; y < r.y1; y++)
   {
-    int activeWidth = maxCol - minCol + 1;
-    // Décalage = centrer activeWidth dans w, puis compenser minCol
-    offsetX = (w - activeWidth) / 2 - minCol;
+    uint16_t *p = _lineBuf;
+    for (int x = r.x0; x < r.x1; x++)
+    {
+      const uint16_t color = LCD_SHADES[shadeAt(_shadeHi[y], _shadeLo[y], x)];
+      for (int i = 0; i < scale; i++)
+        *p++ = color;
+    }
+    for (int i = 0; i < scale; i++)
+      _tft.pushColors(_lineBuf, (uint32_t)w, true);
   }
+}
 
-  // 3) Dessin des pixels avec ce décalage
-  for (int j = 0; j < h; j++)
+void VideoService::pushLcdRectDma(const LcdRect &r, int px, int py, int w, int h, int scale)
+{
+  // Couleurs dans l'ordre des octets du bus (voir busOrder())
+  const uint16_t shades[4] = {busOrder(LCD_SHADES[0]), busOrder(LCD_SHADES[1]), busOrder(LCD_SHADES[2]),
+                              busOrder(LCD_SHADES[3])};
+
+  // Pas de commande de fenêtre pendant un transfert
+  _tft.dmaWait();
+  _tft.setAddrWindow(px, py, w, h);
+  _dmaPending = true;
+
+  // Une ligne LCD par tampon : la suivante se compose pendant l'envoi de la
+  // précédente (pushPixelsDMA() attend la fin du transfert en cours)
+  for (int y = r.y0; y < r.y1; y++)
   {
-    for (int i = 0; i < w; i++)
+    uint16_t *buf = _dmaBuf[_dmaNext];
+    uint16_t *p = buf;
+    for (int x = r.x0; x < r.x1; x++)
+    {
+      const uint16_t color = shades[shadeAt(_shadeHi[y], _shadeLo[y], x)];
+      for (int i = 0; i < scale; i++)
+        *p++ = color;
+    }
+    for (int i = 1; i < scale; i++)
     {
-      int bitIndex = j * w + i;
-      int byteIndex = bitIndex / 8;
-      int bitInByte = bitIndex % 8;
+      memcpy(p, buf, (size_t)w * sizeof(uint16_t));
+      p += w;
+    }
+    _tft.pushPixelsDMA(buf, (uint32_t)(w * scale));
+    _dmaNext ^= 1;
+  }
+}
+
+void VideoService::drawMonoBitmap16x9(int x, int y, const uint8_t *data, int scale)
+{
+  // Colonnes réellement utilisées centrées, puis un fillRect par pixel allumé
+  const int offsetX = iconOffsetX(data);
 
-      bool on = (data[byteIndex] >> bitInByte) & 0x01;
-      if (on)
+  for (int j = 0; j < ICON_BMP_H; j++)
+  {
+    for (int i = 0; i < ICON_BMP_W; i++)
+    {
+      if (iconBit(data, i, j))
       {
         int drawX = x + (i + offsetX) * scale;
         int drawY = y + j * scale;
@@ -234,111 +669,141 @@ void VideoService::drawMonoBitmap16x9(int x, int y, const uint8_t *data, int sca
   }
 }
 
-void VideoService::renderMenuBitmapsTopbar()
+void VideoService::drawIconSlot(int i, bool selected)
 {
-  const int barH = TOP_BAR_H;
-  const int barY = 0;
+  const int slotX = i * ICON_SLOT_W;
+  if (_iconTiles)
+  {
+    _tft.pushImage(slotX, 0, ICON_SLOT_W, ICON_TILE_H, iconTile(i, selected));
+    return;
+  }
 
-  const int count = 8;
-  const int iconW = 16;
-  const int iconH = 9;
-  const int scale = 2;
+  // Sans cache : fond du slot puis pixels de l'icône
+  _tft.fillRect(slotX, 0, ICON_SLOT_W, ICON_TILE_H, selected ? TFT_DARKGREY : TFT_BLACK);
+  drawMonoBitmap16x9(slotX + (ICON_SLOT_W - ICON_BMP_W * ICON_SCALE) / 2, (TOP_BAR_H - ICON_BMP_H * ICON_SCALE) / 2,
+                     bitmaps + (i * 18), ICON_SCALE);
+}
 
-  int iconsAreaW = SCREEN_W - SPEED_BTN_W;
-  int slotW = iconsAreaW / count;
+void VideoService::invalidate()
+{
+  _damage.clear();
+  _damage.add(screenRect(0, 0, SCREEN_W, SCREEN_H));
+}
 
-  int drawW = iconW * scale;
-  int drawH = iconH * scale;
+void VideoService::invalidateRect(int x, int y, int w, int h)
+{
+  _damage.add(screenRect(x, y, w, h).clip(screenRect(0, 0, SCREEN_W, SCREEN_H)));
+}
 
-  int y = barY + (barH - drawH) / 2;
-  // --- Anti-flicker : ne redessiner que si _icons[] a changé ---
-  static bool first = true;
-  static bool lastIcons[ICON_NUM] = {0};
+ScreenRect VideoService::lcdFrameRect() const
+{
+  int offX, offY, scale;
+  lcdArea(offX, offY, scale);
+  return screenRect(offX - 2, offY - 2, LCD_WIDTH * scale + 4, LCD_HEIGHT * scale + 4);
+}
 
-  bool changed = first;
-  if (!first)
+// Bouton (0..3) de la barre du bas allumé pour held, -1 si aucun
+static int heldSlot(LogicalButton held)
+{
+  switch (held)
   {
-    for (int i = 0; i < ICON_NUM; ++i)
-    {
-      if (lastIcons[i] != _icons[i])
-      {
-        changed = true;
-        break;
-      }
-    }
+  case LogicalButton::LEFT:
+    return 0;
+  case LogicalButton::OK:
+    return 1;
+  case LogicalButton::RIGHT:
+    return 2;
+  case LogicalButton::LR:
+    return 3;
+  default:
+    return -1;
   }
+}
 
-  if (!changed)
-    return;
+static ScreenRect buttonRect(int slot)
+{
+  return screenRect(slot * BUTTON_SLOT_W + 6, BUTTONS_Y + 6, BUTTON_SLOT_W - 12, BOTTOM_BAR_H - 12);
+}
 
-  first = false;
+void VideoService::collectDamage()
+{
+  // Icônes : le slot de chaque icône qui a changé
   for (int i = 0; i < ICON_NUM; ++i)
   {
-    lastIcons[i] = _icons[i];
+    if (_drawnIcons[i] == _icons[i])
+      continue;
+    _drawnIcons[i] = _icons[i];
+    _damage.add(screenRect(i * ICON_SLOT_W, 0, ICON_SLOT_W, ICON_TILE_H));
   }
-  // -------------------------------------------------------------
-
-  // Clear barre (uniquement la zone des icônes)
-  _tft.fillRect(0, barY, iconsAreaW, barH, TFT_BLACK);
 
-  // highlight slot sélectionné
-  for (int i = 0; i < count; i++)
+  // SPD : multiplicateur, ou vitesse atteinte en mode MAX
+  const uint16_t achieved = _shownTimeMult == TIME_MULT_MAX ? _shownSpeed : 0;
+  if (_drawnTimeMult != _shownTimeMult || _drawnSpeed != achieved)
   {
-    if (_icons[i])
-    {
-      int slotX = i * slotW;
-      _tft.fillRect(slotX, barY, slotW, barH, TFT_DARKGREY);
-    }
+    _drawnTimeMult = _shownTimeMult;
+    _drawnSpeed = achieved;
+    _damage.add(SPEED_AREA);
   }
 
-  // icônes (boîte 16x9 centrée dans le slot)
-  for (int i = 0; i < count; i++)
+  // Boutons : celui qui s'éteint et celui qui s'allume
+  const LogicalButton held = _input ? _input->getHeld() : LogicalButton::NONE;
+  if (held != _drawnHeld)
   {
-    int centerX = i * slotW + slotW / 2;
-    int x = centerX - drawW / 2;
-
-    const uint8_t *icon = bitmaps + (i * 18);
-    drawMonoBitmap16x9(x, y, icon, scale);
+    const int was = heldSlot(_drawnHeld);
+    const int now = heldSlot(held);
+    if (was >= 0)
+      _damage.add(buttonRect(was));
+    if (now >= 0)
+      _damage.add(buttonRect(now));
+    _drawnHeld = held;
   }
-
-  _tft.drawFastHLine(0, barH - 1, SCREEN_W, TFT_DARKGREY);
 }
 
-void VideoService::renderTouchButtonsBar()
+void VideoService::flushDamage()
 {
-  const int barH = BOTTOM_BAR_H;
-  const int barY = SCREEN_H - barH;
-  const int count = 4;
-  const int slotW = SCREEN_W / count;
+  if (_damage.intersects(ICONS_AREA))
+    paintIcons();
+  if (_damage.intersects(SPEED_AREA))
+    paintSpeedButton();
+  if (_damage.intersects(BUTTONS_AREA))
+    paintButtons();
+  if (_damage.intersects(LCD_AREA))
+    paintLcdBackdrop();
+  _damage.clear();
+}
 
-  // On lit l'état via InputService (si dispo)
-  LogicalButton held = LogicalButton::NONE;
-  if (_input)
+void VideoService::paintIcons()
+{
+  // Une tuile par slot endommagé, séparateur si sa ligne l'est
+  for (int i = 0; i < ICON_NUM; ++i)
   {
-    held = _input->getHeld(); // LEFT / OK / RIGHT / LR / NONE
+    if (_damage.intersects(screenRect(i * ICON_SLOT_W, 0, ICON_SLOT_W, ICON_TILE_H)))
+      drawIconSlot(i, _drawnIcons[i]);
   }
 
-  // Anti-flicker simple : redraw seulement si changement
-  static bool first = true;
-  static LogicalButton lastHeld = LogicalButton::NONE;
-
-  if (!first && held == lastHeld)
-    return;
-
-  first = false;
-  lastHeld = held;
+  const ScreenRect separator = screenRect(ICONS_AREA.x0, TOP_BAR_H - 1, ICONS_AREA.x1 - ICONS_AREA.x0, 1);
+  if (_damage.intersects(separator))
+    _tft.drawFastHLine(separator.x0, separator.y0, separator.x1 - separator.x0, TFT_DARKGREY);
+}
 
-  _tft.fillRect(0, barY, SCREEN_W, barH, TFT_BLACK);
+void VideoService::paintButtons()
+{
+  const int barH = BOTTOM_BAR_H;
+  const int barY = BUTTONS_Y;
+  const int slotW = BUTTON_SLOT_W;
 
-  for (int i = 0; i < count; i++)
+  for (int i = 0; i < BUTTON_COUNT; i++)
   {
     int x = i * slotW;
+    const ScreenRect slot = screenRect(x, barY + 1, slotW, barH - 1);
+    if (!_damage.intersects(slot))
+      continue;
 
-    bool isActive =
-        (held == LogicalButton::LEFT && i == 0) ||
-        (held == LogicalButton::OK && i == 1) ||
-        (held == LogicalButton::RIGHT && i == 2) ||
-        (held == LogicalButton::LR && i == 3);
+    // Fond noir du slot seulement si un dommage déborde du bouton
+    if (!_damage.within(slot, buttonRect(i)))
+      _tft.fillRect(slot.x0, slot.y0, slotW, barH - 1, TFT_BLACK);
+
+    bool isActive = heldSlot(_drawnHeld) == i;
 
     uint16_t fill = isActive ? TFT_DARKGREY : TFT_BLACK;
 
@@ -354,30 +819,21 @@ void VideoService::renderTouchButtonsBar()
 
     int charCount = (i == 1 || i == 3) ? 2 : 1; // "OK" et "LR" sur 2 chars
     int tx = x + slotW / 2 - (charCount == 2 ? 12 : 6);
-    // int tx = x + slotW / 2 - ((i == 1) ? 12 : 6);
     int ty = barY + barH / 2 - 8;
 
     _tft.setCursor(tx, ty);
     _tft.print(label);
   }
 
-  _tft.drawFastHLine(0, barY, SCREEN_W, TFT_DARKGREY);
+  if (_damage.intersects(screenRect(0, barY, SCREEN_W, 1)))
+    _tft.drawFastHLine(0, barY, SCREEN_W, TFT_DARKGREY);
 }
 
-void VideoService::renderSpeedButtonTopbar()
+void VideoService::paintSpeedButton()
 {
-  // --- Anti-flicker : ne redessiner que si timeMult change ---
-  static bool first = true;
-  static uint8_t lastTimeMult = 0;
-
-  if (!first && lastTimeMult == timeMult)
-  {
-    return;
-  }
-
-  first = false;
-  lastTimeMult = timeMult;
-  // -----------------------------------------------------------
+  const uint8_t mult = _drawnTimeMult;
+  bool isMax = (mult == TIME_MULT_MAX);
+  uint16_t achieved = _drawnSpeed;
 
   uint16_t bg = TFT_BLACK;
   _tft.fillRect(SPEED_BTN_X, SPEED_BTN_Y, SPEED_BTN_W, SPEED_BTN_H, bg);
@@ -397,25 +853,178 @@ void VideoService::renderSpeedButtonTopbar()
   int ty = SPEED_BTN_Y + (SPEED_BTN_H - textH) / 2;
 
   _tft.setCursor(tx, ty);
-  _tft.print("SPD x");
-  _tft.print(timeMult);
+  if (isMax)
+  {
+    // "MAX x<vitesse atteinte>" : 4 chiffres max pour tenir dans le bouton
+    _tft.print("MAX x");
+    _tft.print((unsigned int)(achieved > 9999 ? 9999 : achieved));
+  }
+  else
+  {
+    _tft.print("SPD x");
+    _tft.print(mult);
+  }
+}
+
+void VideoService::paintLcdBackdrop()
+{
+  // Bande noire autour du cadre, là où un dommage en déborde ; cadre, fond
+  // et pixels allumés sont repeints en entier par renderMatrixToTft()
+  const ScreenRect frame = lcdFrameRect();
+  for (uint8_t i = 0; i < _damage.count(); i++)
+  {
+    const ScreenRect r = _damage[i].clip(LCD_AREA);
+    if (r.empty() || frame.contains(r))
+      continue;
+    // r moins le cadre : bandes au-dessus, au-dessous, à gauche, à droite
+    const ScreenRect mid = r.clip({r.x0, frame.y0, r.x1, frame.y1});
+    const ScreenRect strips[4] = {
+        r.clip({r.x0, r.y0, r.x1, frame.y0}),
+        r.clip({r.x0, frame.y1, r.x1, r.y1}),
+        mid.clip({mid.x0, mid.y0, frame.x0, mid.y1}),
+        mid.clip({frame.x1, mid.y0, mid.x1, mid.y1}),
+    };
+    for (const ScreenRect &b : strips)
+    {
+      if (!b.empty())
+        _tft.fillRect(b.x0, b.y0, b.x1 - b.x0, b.y1 - b.y0, TFT_BLACK);
+    }
+  }
+  clearDrawnShades();
+  _lcdFullRedraw = true;
 }
 
 void VideoService::updateScreen()
 {
-  uint64_t now = (uint64_t)esp_timer_get_time();
-  uint32_t interval = 1000000UL / RENDER_FPS;
+  LcdFrame frame;
+  captureFrame(frame);
+  presentFrame(frame);
+  renderScreen();
+}
+
+void VideoService::captureFrame(LcdFrame &frame)
+{
+  syncLcd();
+  memcpy(frame.matrix, _lcdMatrix, sizeof(frame.matrix));
+  memcpy(frame.icons, _lcdIcons, sizeof(frame.icons));
+  frame.timeMult = timeMult;
+  frame.achievedSpeed = achievedSpeed;
+  frame.generation = _lcdGeneration;
+}
 
-  if (now - _lastRenderRealUs < interval)
+uint32_t VideoService::screenRevision()
+{
+  syncLcd();
+  // La vitesse mesurée n'est affichée qu'en mode MAX
+  const uint16_t speed = timeMult == TIME_MULT_MAX ? achievedSpeed : 0;
+  if (timeMult != _revTimeMult || speed != _revSpeed)
   {
-    return;
+    _revTimeMult = timeMult;
+    _revSpeed = speed;
+    _lcdRevision++;
+  }
+  return _lcdRevision;
+}
+
+void VideoService::presentFrame(const LcdFrame &frame)
+{
+  for (int y = 0; y < LCD_HEIGHT; y++)
+    _matrixRows[y] = rowBits(frame.matrix, y);
+  memcpy(_icons, frame.icons, sizeof(_icons));
+  _shownTimeMult = frame.timeMult;
+  _shownSpeed = frame.achievedSpeed;
+  _framePending = true;
+
+  // État importé (save-state, rewind) : redessin complet
+  if (frame.generation != _shownGeneration)
+  {
+    _shownGeneration = frame.generation;
+    clearDrawnShades();
+    _lcdFullRedraw = true;
   }
+}
+
+bool VideoService::renderDue(uint64_t now)
+{
+  const uint64_t elapsed = now - _lastRenderRealUs;
+  const uint32_t minInterval =
+      _shownTimeMult == TIME_MULT_MAX ? 1000000UL / RENDER_FPS : ESPGOTCHI_RENDER_MIN_INTERVAL_MS * 1000UL;
+  if (elapsed < minInterval)
+    return false;
+
+  // Quelque chose à montrer : nouvelle trame, bouton tenu, zone invalidée
+  if (_framePending || _lcdFullRedraw || _damage.count() != 0)
+    return true;
+  if (_input && _input->getHeld() != _drawnHeld)
+    return true;
+
+  // Rémanence en cours : les niveaux évoluent d'un cran par rendu, à RENDER_FPS
+  return !_shadesSettled && elapsed >= 1000000UL / RENDER_FPS;
+}
+
+bool VideoService::renderScreen()
+{
+  const uint64_t now = (uint64_t)esp_timer_get_time();
+  if (!renderDue(now))
+    return false;
   _lastRenderRealUs = now;
+  _framePending = false;
 
-  renderMenuBitmapsTopbar();
-  renderSpeedButtonTopbar();
+  finishLcdDma();
+  collectDamage();
+  flushDamage();
+  // En dernier : avec le DMA, son transfert chevauche la suite de l'émulation
   renderMatrixToTft();
-  renderTouchButtonsBar();
+  // Après le lancement du DMA : l'envoi série (bloquant) le recouvre
+  streamFrame();
+  return true;
+}
+
+void VideoService::streamFrame()
+{
+  if (!_streamOn.load(std::memory_order_relaxed))
+  {
+    _streamActive = false;
+    return;
+  }
+  if (!_streamActive)
+  {
+    // (Re)démarrage : image clé d'abord
+    _stream.reset();
+    _streamActive = true;
+  }
+
+  uint8_t frame[LcdStream::FRAME_BYTES];
+  uint8_t *p = frame;
+  for (int y = 0; y < LCD_HEIGHT; y++)
+  {
+    for (int b = 0; b < LCD_WIDTH / 8; b++)
+      *p++ = (uint8_t)(_matrixRows[y] >> (24 - 8 * b));
+  }
+  uint8_t icons = 0;
+  for (int i = 0; i < ICON_NUM; i++)
+    icons |= (_icons[i] ? 1 : 0) << i;
+  *p = icons;
+
+  uint8_t packet[LcdStream::MAX_PACKET];
+  const size_t len = _stream.encode(frame, packet);
+  if (len == 0)
+    return;
+
+  // Une seule écriture : la ligne ne se mêle pas aux logs de l'autre cœur
+  static const char hex[] = "0123456789ABCDEF";
+  char line[3 + 2 * LcdStream::MAX_PACKET + 1];
+  size_t n = 0;
+  line[n++] = 'L';
+  line[n++] = 'S';
+  line[n++] = ' ';
+  for (size_t i = 0; i < len; i++)
+  {
+    line[n++] = hex[packet[i] >> 4];
+    line[n++] = hex[packet[i] & 0x0F];
+  }
+  line[n++] = '\n';
+  Serial.write(line, n);
 }
 
 bool VideoService::isInsideSpeedButton(uint16_t x, uint16_t y) const
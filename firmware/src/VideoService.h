@@ -2,7 +2,10 @@
 
 #include <Arduino.h>
 #include <TFT_eSPI.h>
+#include <atomic>
 #include "UiLayout.h"   // NEW : constantes d'UI partagées
+#include "UiDamage.h"
+#include "LcdStream.h"
 
 extern "C"
 {
@@ -10,9 +13,53 @@ extern "C"
 #include "hw.h"
 #include "hal.h"
 #include "cpu.h"
+#include "arduinogotchi_core/espgotchi_lcd.h"
 }
 
 class InputService;
+enum class LogicalButton : uint8_t;
+
+// Zone LCD envoyée par DMA (ESP32 : tampons en RAM interne DMA-capable,
+// repli sur l'écriture directe si l'allocation ou initDMA() échoue)
+#ifndef ESPGOTCHI_LCD_DMA
+#define ESPGOTCHI_LCD_DMA 1
+#endif
+
+// Rémanence de l'écran LCD : chaque pixel garde un niveau de gris (0..3)
+// qui monte de 2 s'il est allumé et descend de 1 s'il est éteint à chaque
+// rendu ; les animations rapides laissent une traînée au lieu de clignoter
+#ifndef ESPGOTCHI_LCD_GHOSTING
+#define ESPGOTCHI_LCD_GHOSTING 0
+#endif
+
+// Flux série de l'écran LCD au démarrage (voir LcdStream), sinon commande
+// série "lcd stream on"
+#ifndef ESPGOTCHI_LCD_STREAM
+#define ESPGOTCHI_LCD_STREAM 0
+#endif
+
+// Ordonnancement du rendu : une image n'est dessinée que si son contenu a
+// changé (matrice, icônes, SPD, bouton tenu), au plus une fois toutes les
+// ESPGOTCHI_RENDER_MIN_INTERVAL_MS (1000 / RENDER_FPS en mode MAX). Côté
+// émulation (TamaHost), un changement attend que le ROM ait fini de
+// redessiner l'écran, au plus ESPGOTCHI_RENDER_LATENCY_MS.
+#ifndef ESPGOTCHI_RENDER_MIN_INTERVAL_MS
+#define ESPGOTCHI_RENDER_MIN_INTERVAL_MS 40
+#endif
+#ifndef ESPGOTCHI_RENDER_LATENCY_MS
+#define ESPGOTCHI_RENDER_LATENCY_MS 50
+#endif
+
+// Instantané de l'écran émulé, passé du cœur d'émulation au cœur
+// d'affichage (voir TamaHost, mode double cœur)
+struct LcdFrame
+{
+  bool_t matrix[LCD_HEIGHT][LCD_WIDTH / 8];
+  bool_t icons[ICON_NUM];
+  uint8_t timeMult;       // bouton SPD
+  uint16_t achievedSpeed; // vitesse affichée en mode MAX
+  uint16_t generation;    // change à chaque importState() : redessin complet
+};
 
 class VideoService
 {
@@ -28,6 +75,8 @@ public:
   // Helpers “app”
   void clearScreen();
   void showSplash(const char *text);
+  // Barre de progression sous le splash (rattrapage au boot), pct 0..100
+  void showProgress(const char *label, uint8_t pct);
 
   // Brancher l'input
   void setInputService(InputService *input);
@@ -35,31 +84,168 @@ public:
   // Hooks HAL
   void setLcdMatrix(u8_t x, u8_t y, bool_t val);
   void setLcdIcon(u8_t icon, bool_t val);
+
+  // Un seul cœur : captureFrame() + presentFrame() + renderScreen()
   void updateScreen();
 
+  // Côté émulation : instantané de l'écran émulé (après syncLcd())
+  void captureFrame(LcdFrame &frame);
+  // Côté émulation : compteur des changements de ce que captureFrame()
+  // copierait (matrice, icônes, SPD, vitesse en mode MAX), syncLcd() compris
+  uint32_t screenRevision();
+  // Côté affichage : trame dessinée par le prochain renderScreen()
+  void presentFrame(const LcdFrame &frame);
+  // Dessine ce qui a changé depuis le dernier rendu (trame présentée, bouton
+  // tenu, zones invalidées, rémanence en cours), au plus une fois par
+  // intervalle minimum. Retourne false si rien n'a été dessiné.
+  bool renderScreen();
+
+  // Compositeur : l'écran est pavé de widgets (barre d'icônes, bouton SPD,
+  // zone LCD, barre de boutons) qui ne repeignent que leurs zones
+  // endommagées. À appeler côté affichage après un dessin hors widgets
+  // (splash, overlay) : la zone est repeinte au prochain renderScreen().
+  void invalidate();
+  void invalidateRect(int x, int y, int w, int h);
+
+  // Mode paresseux (espgotchi_lcd) : redécode matrice + icônes depuis la
+  // mémoire d'affichage si elle a changé. Appelé avant rendu et export.
+  void syncLcd();
+
+  // Save-state : matrice LCD + icônes (section hôte de l'instantané)
+  static constexpr size_t STATE_SIZE = LCD_HEIGHT * (LCD_WIDTH / 8) + ICON_NUM;
+  size_t exportState(uint8_t *out, size_t cap);
+  bool importState(const uint8_t *in, size_t len);
+
+  // Rémanence (voir ESPGOTCHI_LCD_GHOSTING), côté affichage
+  void setGhosting(bool on);
+  bool ghosting() const { return _ghosting; }
+
+  // Flux série : une ligne "LS <hex>" par image affichée dont la matrice ou
+  // les icônes ont changé (au plus une par intervalle minimum, au milieu des
+  // logs ; à décoder avec le natif : --decode-lcd). Activable de tout cœur,
+  // émis côté affichage. Statistiques : côté affichage.
+  void setLcdStream(bool on) { _streamOn.store(on, std::memory_order_relaxed); }
+  bool lcdStreaming() const { return _streamOn.load(std::memory_order_relaxed); }
+  const LcdStreamStats &lcdStreamStats() const { return _stream.stats(); }
+
   // Utilitaire pour TamaHost / handler() : hit test bouton SPD
   bool isInsideSpeedButton(uint16_t x, uint16_t y) const;
 
+#ifdef ESPGOTCHI_NATIVE
+  // Cible native : accès à l'écran en mémoire (compteurs + capture PPM)
+  const NativeTftStats &tftStats() const { return _tft.stats(); }
+  bool saveScreenshot(const char *path) const { return _tft.savePpm(path); }
+#endif
+
 private:
+  friend class EspgotchiBench; // banc de mesure (src/bench) : diffShades(), renderMatrixToTft()
+
   TFT_eSPI _tft; // propriété du service
 
   InputService *_input = nullptr;
 
-  // Buffers internes (équivalents aux statiques actuels)
-  bool_t _matrix[LCD_HEIGHT][LCD_WIDTH / 8];
-  bool_t _prevMatrix[LCD_HEIGHT][LCD_WIDTH / 8];   // <--- NEW
-  bool_t _icons[ICON_NUM];
+  // Écran émulé (côté émulation : HAL, syncLcd(), save-states)
+  bool_t _lcdMatrix[LCD_HEIGHT][LCD_WIDTH / 8];
+  bool_t _lcdIcons[ICON_NUM];
+  uint16_t _lcdGeneration = 0;
+  uint32_t _lcdRevision = 0;
+  uint8_t _revTimeMult = 0xFF; // SPD et vitesse comptés dans _lcdRevision
+  uint16_t _revSpeed = 0;
 
+  // Trame affichée (côté affichage : tout le rendu ne lit que ceci), une
+  // ligne LCD par mot (pixel x sur le bit 31 - x)
+  uint32_t _matrixRows[LCD_HEIGHT];
+  bool_t _icons[ICON_NUM];
+  uint8_t _shownTimeMult = 1;
+  uint16_t _shownSpeed = 1;
+  uint16_t _shownGeneration = 0;
+  bool _framePending = false; // trame présentée pas encore dessinée
 
   uint64_t _lastRenderRealUs = 0;
-  uint32_t _lastMatrixHash = 0;
-  bool _firstMatrixRender = true;     
+  bool _lcdFullRedraw = true; // cadre + fond + tous les pixels au prochain rendu
+
+  // Niveau de chaque pixel LCD en deux plans de bits par ligne (pixel x sur
+  // le bit 31 - x) : niveau = 2·hi + lo, 0 = éteint, 3 = allumé. Sans
+  // rémanence, hi = lo = pixel. _drawn* : niveaux à l'écran (delta).
+  uint32_t _shadeHi[LCD_HEIGHT];
+  uint32_t _shadeLo[LCD_HEIGHT];
+  uint32_t _drawnHi[LCD_HEIGHT];
+  uint32_t _drawnLo[LCD_HEIGHT];
+  bool _ghosting = ESPGOTCHI_LCD_GHOSTING;
+  bool _shadesSettled = true; // tous les niveaux à 0 ou 3 : rien n'évolue
+
+  // Flux série (_streamOn : demandé, _streamActive : en cours côté affichage)
+  std::atomic<bool> _streamOn{ESPGOTCHI_LCD_STREAM};
+  bool _streamActive = false;
+  LcdStream _stream;
+
+  // Compositeur : zones à repeindre, et état que les widgets montrent (mis
+  // à jour par collectDamage(), lu par les paint*())
+  DamageList<16> _damage;
+  bool_t _drawnIcons[ICON_NUM];
+  uint8_t _drawnTimeMult = 0;
+  uint16_t _drawnSpeed = 0;
+  LogicalButton _drawnHeld{};
   
+  // Rectangle de pixels LCD à redessiner : colonnes [x0, x1), lignes [y0, y1)
+  struct LcdRect
+  {
+    uint8_t x0, x1, y0, y1;
+  };
+
+  // Niveaux calculés (_shade*) contre niveaux à l'écran (_drawn*) : lignes
+  // modifiées, croissantes, et pour chacune ses suites de pixels modifiés
+  // [x0, x1), spans[firstSpan[i] .. firstSpan[i + 1]) pour la ligne rows[i]
+  struct LcdSpan
+  {
+    uint8_t x0, x1;
+  };
+  struct LcdDiff
+  {
+    uint8_t rowCount;
+    uint8_t rows[LCD_HEIGHT];
+    uint16_t firstSpan[LCD_HEIGHT + 1];
+    LcdSpan spans[LCD_HEIGHT * LCD_WIDTH / 2];
+  };
+
+  // Une ligne LCD agrandie (au plus la largeur de l'écran), pour pushColors()
+  uint16_t _lineBuf[SCREEN_W];
+
+  // Double tampon DMA : une ligne LCD agrandie (largeur x scale lignes TFT),
+  // composée dans un tampon pendant que l'autre part sur le bus SPI
+  uint16_t *_dmaBuf[2] = {nullptr, nullptr};
+  uint8_t _dmaNext = 0;
+  bool _dmaReady = false;
+  bool _dmaPending = false; // transaction ouverte, transfert peut-être en cours
+
+  // Barre d'icônes pré-rendue (initDisplay()) : une tuile RGB565 par icône
+  // et par état (0 = normal, 1 = sélectionnée), dans l'ordre du bus ;
+  // nullptr si l'allocation a échoué (repli sur un fillRect par pixel)
+  uint16_t *_iconTiles = nullptr;
+
   // Helpers internes
-  uint32_t hashMatrix() const;
+  bool matrixUnchanged() const;
+  void diffShades(LcdDiff &diff) const;
+  void lcdArea(int &offX, int &offY, int &scale) const;
+  void beginLcdDma();
+  void finishLcdDma();
   void renderMatrixToTft();
-  void renderMenuBitmapsTopbar();
-  void renderTouchButtonsBar();
-  void renderSpeedButtonTopbar();
+  bool renderDue(uint64_t now);
+  void updateShades();
+  void clearDrawnShades();
+  void streamFrame();
+  static uint32_t rowBits(const bool_t matrix[LCD_HEIGHT][LCD_WIDTH / 8], int y);
+  void drawLcdRect(const LcdRect &r, int offX, int offY, int scale);
+  void pushLcdRectDma(const LcdRect &r, int px, int py, int w, int h, int scale);
+  void buildIconTiles();
+  uint16_t *iconTile(int icon, bool selected) const;
+  void drawIconSlot(int i, bool selected);
+  ScreenRect lcdFrameRect() const;
+  void collectDamage();
+  void flushDamage();
+  void paintIcons();
+  void paintSpeedButton();
+  void paintButtons();
+  void paintLcdBackdrop();
   void drawMonoBitmap16x9(int x, int y, const uint8_t *data, int scale = 2);
 };
@@ -0,0 +1,80 @@
+#include "WallClock.h"
+#include <time.h>
+
+#ifndef ESPGOTCHI_NATIVE
+#include <WiFi.h>
+#include <esp_sntp.h>
+#endif
+
+// En dessous (avant 2020), l'horloge n'a pas été réglée
+static constexpr uint32_t WALL_CLOCK_MIN = 1577836800u;
+
+#ifdef ESPGOTCHI_NATIVE
+
+static uint32_t s_offset = 0;
+
+bool WallClock::sync()
+{
+  return now() != 0;
+}
+
+uint32_t WallClock::now()
+{
+  const time_t t = time(nullptr);
+  return (t >= (time_t)WALL_CLOCK_MIN) ? (uint32_t)t + s_offset : 0;
+}
+
+void WallClock::advance(uint32_t seconds)
+{
+  s_offset += seconds;
+}
+
+#else
+
+bool WallClock::sync()
+{
+  // Reset logiciel : l'horloge système a survécu
+  if (now() != 0)
+    return true;
+
+  if (ESPGOTCHI_WIFI_SSID[0] == '\0')
+  {
+    Serial.println("[Clock] no time source (ESPGOTCHI_WIFI_SSID unset), boot catch-up disabled");
+    return false;
+  }
+
+  const uint32_t start = millis();
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ESPGOTCHI_WIFI_SSID, ESPGOTCHI_WIFI_PASSWORD);
+  while (WiFi.status() != WL_CONNECTED && millis() - start < ESPGOTCHI_NTP_TIMEOUT_MS)
+    delay(100);
+
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    configTime(0, 0, ESPGOTCHI_NTP_SERVER);
+    while (now() == 0 && millis() - start < ESPGOTCHI_NTP_TIMEOUT_MS)
+      delay(100);
+    sntp_stop();
+  }
+
+  const bool connected = WiFi.status() == WL_CONNECTED;
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+
+  const uint32_t t = now();
+  if (t != 0)
+    Serial.printf("[Clock] SNTP %s: epoch %lu in %lums\n", ESPGOTCHI_NTP_SERVER, (unsigned long)t,
+                  (unsigned long)(millis() - start));
+  else
+    Serial.printf("[Clock] %s, boot catch-up disabled\n",
+                  connected ? "no SNTP answer" : "Wi-Fi " ESPGOTCHI_WIFI_SSID " unreachable");
+  return t != 0;
+}
+
+uint32_t WallClock::now()
+{
+  const time_t t = time(nullptr);
+  return (t >= (time_t)WALL_CLOCK_MIN) ? (uint32_t)t : 0;
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Réseau Wi-Fi pour la synchro SNTP au boot (vide : pas de source d'heure,
+// le rattrapage au boot est désactivé). À passer en build_flags :
+//   -D ESPGOTCHI_WIFI_SSID=\"monreseau\" -D ESPGOTCHI_WIFI_PASSWORD=\"...\"
+#ifndef ESPGOTCHI_WIFI_SSID
+#define ESPGOTCHI_WIFI_SSID ""
+#endif
+#ifndef ESPGOTCHI_WIFI_PASSWORD
+#define ESPGOTCHI_WIFI_PASSWORD ""
+#endif
+#ifndef ESPGOTCHI_NTP_SERVER
+#define ESPGOTCHI_NTP_SERVER "pool.ntp.org"
+#endif
+// Attente maximale de la connexion Wi-Fi puis de la première réponse SNTP
+#ifndef ESPGOTCHI_NTP_TIMEOUT_MS
+#define ESPGOTCHI_NTP_TIMEOUT_MS 15000
+#endif
+
+// Heure murale (secondes epoch UTC) des save-states et du rattrapage au boot.
+// ESP32 : aucune RTC sur le CYD, l'horloge système repart de 0 à chaque mise
+// sous tension ; sync() la règle par SNTP puis coupe le Wi-Fi (l'horloge
+// continue sur le timer système jusqu'au prochain reset).
+// Natif : time(), décalable pour simuler un appareil resté éteint.
+class WallClock
+{
+public:
+  // Règle l'horloge si besoin. false : aucune source (Wi-Fi non configuré,
+  // pas de réseau, pas de réponse SNTP), now() reste à 0.
+  static bool sync();
+
+  // Secondes epoch, 0 si l'horloge n'est pas réglée
+  static uint32_t now();
+
+#ifdef ESPGOTCHI_NATIVE
+  // Natif : avance l'horloge de seconds (--wall-offset)
+  static void advance(uint32_t seconds);
+#endif
+};
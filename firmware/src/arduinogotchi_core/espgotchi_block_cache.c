@@ -0,0 +1,605 @@
+#include <string.h>
+
+#include "espgotchi_block_cache.h"
+#include "espgotchi_cpu_fast.h"
+#include "espgotchi_tama_rom.h"
+#include "espgotchi_cpu_ops.h"
+#include "espgotchi_sched.h"
+#include "espgotchi_profile.h"
+#include "espgotchi_trace.h"
+
+/*
+ * Cache de blocs de base
+ * ----------------------
+ * Un bloc = suite d'instructions ROM linéaires terminée par un saut (JP*,
+ * JPBA, CALL/CALZ, RET/RETS/RETD), ou coupée avant HALT/SLP/opcode inconnu,
+ * ou à ESPGOTCHI_BLOCK_MAX_INSTR. Chaque bloc est traduit une fois en
+ * micro-ops (programme pré-décodé + paires fréquentes fusionnées), puis
+ * exécuté d'un seul tenant : le contrôle de budget (ticks, instructions) se
+ * fait par bloc, et chaque bloc garde en cache ses deux derniers successeurs.
+ *
+ * NP n'est pas recalculé après chaque instruction : seules les instructions
+ * qui le lisent (sauts, CALL) le reconstruisent, et UOP_NP_LIVE indique que
+ * la valeur courante de np est la bonne (début de bloc, ou juste après PSET).
+ */
+
+#define BLOCK_NONE          0xFFFFu
+#define BLOCK_UNTRANSLATABLE 0xFFFEu
+
+/* np contient déjà la valeur vue par cette instruction */
+#define UOP_NP_LIVE         0x01
+
+/* Micro-ops propres au cache, numérotés après les opcodes décodés */
+enum {
+    ESPGOTCHI_OP_EXIT = ESPGOTCHI_OP_COUNT, /* fin de bloc sans saut */
+    ESPGOTCHI_OP_STOP,                      /* fin de budget (posé à l'exécution) */
+    ESPGOTCHI_OP_STOP_SPLIT,                /* idem, après la 1re moitié d'une paire */
+    ESPGOTCHI_OP_LBPX_LBPX,
+    ESPGOTCHI_OP_INC_X_LDPY_R,
+    ESPGOTCHI_OP_LDPY_R_INC_X,
+    ESPGOTCHI_OP_LD_R_I_LD_XP_R,
+    ESPGOTCHI_OP_LD_X_ADD_R_I,
+    ESPGOTCHI_OP_LD_XP_R_LD_X,
+    ESPGOTCHI_OP_LD_X_LD_R_Q,
+    ESPGOTCHI_UOP_COUNT
+};
+
+typedef struct {
+    u8_t kind;   /* espgotchi_op_kind_t ou micro-op ci-dessus */
+    u8_t arg0;
+    u8_t arg1;
+    u8_t arg2;   /* super-instructions uniquement */
+    u8_t idx;    /* rang de l'instruction dans le bloc : pc = start + idx */
+    u8_t flags;  /* UOP_NP_LIVE */
+    uint16_t ticks; /* ticks des instructions précédentes du bloc */
+} espgotchi_uop_t;
+
+typedef struct {
+    u13_t start;
+    u8_t len;        /* instructions ROM couvertes */
+    u8_t uop_count;
+    uint16_t cycles;    /* durée totale du bloc (ticks) */
+    uint16_t first_uop;
+    u13_t link_pc[2]; /* [0] = suite linéaire, [1] = dernière autre cible */
+    uint16_t link[2];
+} espgotchi_block_t;
+
+static espgotchi_block_t *s_blocks = NULL;
+static espgotchi_uop_t *s_uops = NULL;
+static uint16_t *s_block_at = NULL; /* index du bloc démarrant à chaque adresse ROM */
+static u32_t s_prog_words = 0;
+static bool_t s_alloc_failed = 0;
+static bool_t s_full = 0;
+
+static espgotchi_block_cache_stats_t s_stats;
+
+static bool_t espgotchi_block_cache_alloc(void)
+{
+    if (s_blocks != NULL) {
+        return 1;
+    }
+    if (s_alloc_failed) {
+        return 0;
+    }
+
+    s_prog_words = espgotchi_get_tama_program_word_count();
+    s_blocks = (espgotchi_block_t *)g_hal->malloc(sizeof(espgotchi_block_t) * ESPGOTCHI_BLOCK_CACHE_BLOCKS);
+    s_uops = (espgotchi_uop_t *)g_hal->malloc(sizeof(espgotchi_uop_t) * ESPGOTCHI_BLOCK_CACHE_UOPS);
+    s_block_at = (uint16_t *)g_hal->malloc(sizeof(uint16_t) * s_prog_words);
+
+    if (s_blocks == NULL || s_uops == NULL || s_block_at == NULL) {
+        /* Pas de cache : le moteur décodé prend le relais */
+        g_hal->log(LOG_ERROR, "[BlockCache] allocation failed, block engine disabled\n");
+        g_hal->free(s_blocks);
+        g_hal->free(s_uops);
+        g_hal->free(s_block_at);
+        s_blocks = NULL;
+        s_uops = NULL;
+        s_block_at = NULL;
+        s_alloc_failed = 1;
+        return 0;
+    }
+
+    espgotchi_block_cache_flush();
+    s_stats.flushes = 0;
+    return 1;
+}
+
+void espgotchi_block_cache_flush(void)
+{
+    if (s_block_at != NULL) {
+        memset(s_block_at, 0xFF, sizeof(uint16_t) * s_prog_words);
+        s_stats.flushes++;
+    }
+
+    s_stats.blocks = 0;
+    s_stats.uops = 0;
+    s_stats.fused = 0;
+    s_full = 0;
+}
+
+void espgotchi_block_cache_get_stats(espgotchi_block_cache_stats_t *out)
+{
+    *out = s_stats;
+}
+
+static bool_t espgotchi_is_branch(u8_t kind)
+{
+    switch (kind) {
+    case ESPGOTCHI_OP_JP:
+    case ESPGOTCHI_OP_JP_C:
+    case ESPGOTCHI_OP_JP_NC:
+    case ESPGOTCHI_OP_JP_Z:
+    case ESPGOTCHI_OP_JP_NZ:
+    case ESPGOTCHI_OP_JPBA:
+    case ESPGOTCHI_OP_CALL:
+    case ESPGOTCHI_OP_CALZ:
+    case ESPGOTCHI_OP_RET:
+    case ESPGOTCHI_OP_RETS:
+    case ESPGOTCHI_OP_RETD:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Paires fusionnables (les plus fréquentes à l'exécution de la ROM P1).
+ * Remplit u (kind + arguments) et retourne 1 si d0 puis d1 forment une
+ * super-instruction.
+ */
+static bool_t espgotchi_fuse(const espgotchi_decoded_op_t *d0, const espgotchi_decoded_op_t *d1,
+                             espgotchi_uop_t *u)
+{
+    switch ((d0->kind << 8) | d1->kind) {
+    case (ESPGOTCHI_OP_LBPX << 8) | ESPGOTCHI_OP_LBPX:
+        u->kind = ESPGOTCHI_OP_LBPX_LBPX;
+        u->arg0 = d0->arg0;
+        u->arg1 = d1->arg0;
+        return 1;
+    case (ESPGOTCHI_OP_INC_X << 8) | ESPGOTCHI_OP_LDPY_R:
+        u->kind = ESPGOTCHI_OP_INC_X_LDPY_R;
+        u->arg0 = d1->arg0;
+        u->arg1 = d1->arg1;
+        return 1;
+    case (ESPGOTCHI_OP_LDPY_R << 8) | ESPGOTCHI_OP_INC_X:
+        u->kind = ESPGOTCHI_OP_LDPY_R_INC_X;
+        u->arg0 = d0->arg0;
+        u->arg1 = d0->arg1;
+        return 1;
+    case (ESPGOTCHI_OP_LD_R_I << 8) | ESPGOTCHI_OP_LD_XP_R:
+        u->kind = ESPGOTCHI_OP_LD_R_I_LD_XP_R;
+        u->arg0 = d0->arg0;
+        u->arg1 = d0->arg1;
+        u->arg2 = d1->arg0;
+        return 1;
+    case (ESPGOTCHI_OP_LD_X << 8) | ESPGOTCHI_OP_ADD_R_I:
+        u->kind = ESPGOTCHI_OP_LD_X_ADD_R_I;
+        u->arg0 = d0->arg0;
+        u->arg1 = d1->arg0;
+        u->arg2 = d1->arg1;
+        return 1;
+    case (ESPGOTCHI_OP_LD_XP_R << 8) | ESPGOTCHI_OP_LD_X:
+        u->kind = ESPGOTCHI_OP_LD_XP_R_LD_X;
+        u->arg0 = d0->arg0;
+        u->arg1 = d1->arg0;
+        return 1;
+    case (ESPGOTCHI_OP_LD_X << 8) | ESPGOTCHI_OP_LD_R_Q:
+        u->kind = ESPGOTCHI_OP_LD_X_LD_R_Q;
+        u->arg0 = d0->arg0;
+        u->arg1 = d1->arg0;
+        u->arg2 = d1->arg1;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Traduit le bloc démarrant à pc. Retourne son index, BLOCK_UNTRANSLATABLE
+ * si pc ne peut pas démarrer de bloc, ou BLOCK_NONE si le cache est plein.
+ */
+static uint16_t espgotchi_translate(u13_t pc)
+{
+    const espgotchi_decoded_op_t *const prog = espgotchi_get_tama_decoded_program();
+    espgotchi_block_t *blk;
+    espgotchi_uop_t *u;
+    u32_t first = s_stats.uops;
+    u32_t cur = pc;
+    uint16_t ticks = 0;
+    u8_t idx = 0;
+    bool_t after_pset = 0;
+    bool_t ended = 0;
+
+    if (s_stats.blocks >= ESPGOTCHI_BLOCK_CACHE_BLOCKS) {
+        s_full = 1;
+        return BLOCK_NONE;
+    }
+
+    while (idx < ESPGOTCHI_BLOCK_MAX_INSTR && cur < s_prog_words) {
+        const espgotchi_decoded_op_t *d = &prog[cur];
+        u8_t span = 1;
+
+        if (d->kind == ESPGOTCHI_OP_HALT || d->kind == ESPGOTCHI_OP_SLP || d->kind == ESPGOTCHI_OP_UNKNOWN) {
+            break;
+        }
+
+        /* Place pour ce micro-op + un EXIT éventuel */
+        if (s_stats.uops + 2 > ESPGOTCHI_BLOCK_CACHE_UOPS) {
+            s_full = 1;
+            return BLOCK_NONE;
+        }
+
+        u = &s_uops[s_stats.uops++];
+        u->idx = idx;
+        u->flags = (idx == 0 || after_pset) ? UOP_NP_LIVE : 0;
+        u->ticks = ticks;
+        u->arg2 = 0;
+
+        if (idx + 1 < ESPGOTCHI_BLOCK_MAX_INSTR && cur + 1 < s_prog_words && espgotchi_fuse(d, &prog[cur + 1], u)) {
+            ticks += d->cycles + prog[cur + 1].cycles;
+            s_stats.fused++;
+            span = 2;
+            d = &prog[cur + 1];
+        } else {
+            u->kind = d->kind;
+            u->arg0 = d->arg0;
+            u->arg1 = d->arg1;
+            ticks += d->cycles;
+        }
+
+        idx += span;
+        cur += span;
+        after_pset = (d->kind == ESPGOTCHI_OP_PSET);
+
+        if (espgotchi_is_branch(d->kind)) {
+            ended = 1;
+            break;
+        }
+    }
+
+    if (idx == 0) {
+        s_block_at[pc] = BLOCK_UNTRANSLATABLE;
+        return BLOCK_UNTRANSLATABLE;
+    }
+
+    if (!ended) {
+        u = &s_uops[s_stats.uops++];
+        u->kind = ESPGOTCHI_OP_EXIT;
+        u->arg0 = 0;
+        u->arg1 = 0;
+        u->arg2 = 0;
+        u->idx = idx;
+        u->flags = after_pset ? UOP_NP_LIVE : 0;
+        u->ticks = ticks;
+    }
+
+    blk = &s_blocks[s_stats.blocks];
+    blk->start = pc;
+    blk->len = idx;
+    blk->uop_count = (u8_t)(s_stats.uops - first);
+    blk->cycles = ticks;
+    blk->first_uop = (uint16_t)first;
+    blk->link_pc[0] = (pc + idx) & 0x1FFF;
+    blk->link_pc[1] = 0xFFFF;
+    blk->link[0] = BLOCK_NONE;
+    blk->link[1] = BLOCK_NONE;
+
+    s_stats.translations++;
+    s_block_at[pc] = (uint16_t)s_stats.blocks;
+    return (uint16_t)s_stats.blocks++;
+}
+
+static uint16_t espgotchi_block_lookup(u13_t pc)
+{
+    uint16_t b;
+
+    if (pc >= s_prog_words) {
+        return BLOCK_UNTRANSLATABLE;
+    }
+
+    b = s_block_at[pc];
+    if (b == BLOCK_NONE) {
+        b = espgotchi_translate(pc);
+    }
+    return b;
+}
+
+#define CUR_PC          ((u13_t)((blk_start + u->idx) & 0x1FFF))
+#define NP              ((u->flags & UOP_NP_LIVE) ? np : ((CUR_PC >> 8) & 0x1F))
+
+/* Trace : une entrée par micro-op (une paire fusionnée couvre deux adresses) */
+#define TRACE_UOP() \
+    ESPGOTCHI_TRACE_OP(CUR_PC, ESPGOTCHI_TRACE_BLOCK | ((u->kind > ESPGOTCHI_OP_STOP_SPLIT) ? ESPGOTCHI_TRACE_PAIR : 0), \
+                       a, b, sp, x, y, flags)
+
+#define FALLBACK()      goto stop_in_block
+#define FALLBACK_SECOND() do { ESPGOTCHI_TRACE_OP(CUR_PC, ESPGOTCHI_TRACE_BLOCK, a, b, sp, x, y, flags); goto stop_after_first; } while (0)
+#define BRANCH()        do { ESPGOTCHI_TRACE_OP(CUR_PC, ESPGOTCHI_TRACE_BLOCK, a, b, sp, x, y, flags); goto branch_done; } while (0)
+#define PSET_NEXT()     NEXT()
+
+#if defined(__GNUC__)
+#define OP(kind)        L_##kind:
+#define NEXT()          do { TRACE_UOP(); u++; arg0 = u->arg0; arg1 = u->arg1; goto *s_dispatch[u->kind]; } while (0)
+#else
+#define OP(kind)        case ESPGOTCHI_OP_##kind:
+#define NEXT()          do { TRACE_UOP(); u++; arg0 = u->arg0; arg1 = u->arg1; goto dispatch; } while (0)
+#endif
+
+u32_t espgotchi_block_run(u32_t max_instr, u32_t *ticks)
+{
+    state_t *st = cpu_get_state();
+    MEM_BUFFER_TYPE *mem;
+    bool_t int_pending = 0;
+    u32_t tick_limit;
+    u32_t count = 0, acc = 0;
+    u32_t depth;
+    u13_t pc, next_pc, tmp_pc, blk_start;
+    u12_t x, y;
+    u4_t a, b, flags;
+    u5_t np;
+    u8_t sp, tmp, arg0, arg1, slot;
+    espgotchi_block_t *blk;
+    const espgotchi_uop_t *u;
+    espgotchi_uop_t *patched = NULL;
+    espgotchi_uop_t patched_save[2];
+    bool_t split = 0;
+    uint16_t bi;
+    u8_t i, k;
+
+#if defined(__GNUC__)
+    static const void *const s_dispatch[ESPGOTCHI_UOP_COUNT] = {
+#define ESPGOTCHI_OP_LABEL(kind, code, mask, shift, mask_arg0, cycles, name) [ESPGOTCHI_OP_##kind] = &&L_##kind,
+        ESPGOTCHI_OP_LIST(ESPGOTCHI_OP_LABEL)
+#undef ESPGOTCHI_OP_LABEL
+        [ESPGOTCHI_OP_UNKNOWN] = &&L_UNKNOWN,
+        [ESPGOTCHI_OP_EXIT] = &&L_EXIT,
+        [ESPGOTCHI_OP_STOP] = &&L_STOP,
+        [ESPGOTCHI_OP_STOP_SPLIT] = &&L_STOP_SPLIT,
+        [ESPGOTCHI_OP_LBPX_LBPX] = &&L_LBPX_LBPX,
+        [ESPGOTCHI_OP_INC_X_LDPY_R] = &&L_INC_X_LDPY_R,
+        [ESPGOTCHI_OP_LDPY_R_INC_X] = &&L_LDPY_R_INC_X,
+        [ESPGOTCHI_OP_LD_R_I_LD_XP_R] = &&L_LD_R_I_LD_XP_R,
+        [ESPGOTCHI_OP_LD_X_ADD_R_I] = &&L_LD_X_ADD_R_I,
+        [ESPGOTCHI_OP_LD_XP_R_LD_X] = &&L_LD_XP_R_LD_X,
+        [ESPGOTCHI_OP_LD_X_LD_R_Q] = &&L_LD_X_LD_R_Q,
+    };
+#endif
+
+    *ticks = 0;
+
+    if (!espgotchi_block_cache_alloc() || *st->cpu_halted) {
+        return 0;
+    }
+
+    /* Cache plein au lot précédent : on repart de zéro (aucun bloc en cours) */
+    if (s_full) {
+        espgotchi_block_cache_flush();
+    }
+
+    tick_limit = espgotchi_sched_budget();
+    if (tick_limit == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < INT_SLOT_NUM; ++i) {
+        int_pending |= st->interrupts[i].triggered;
+    }
+
+    flags = *st->flags;
+    if ((flags & FLAG_I) && int_pending) {
+        return 0;
+    }
+
+    pc = *st->pc;
+    bi = espgotchi_block_lookup(pc);
+    if (bi >= BLOCK_UNTRANSLATABLE) {
+        return 0;
+    }
+    blk = &s_blocks[bi];
+
+    mem = st->memory;
+    x = *st->x;
+    y = *st->y;
+    a = *st->a;
+    b = *st->b;
+    np = *st->np;
+    sp = *st->sp;
+    depth = *st->call_depth;
+
+    for (;;) {
+        blk_start = blk->start;
+        u = &s_uops[blk->first_uop];
+
+        /* Bloc plus long que le budget restant : on l'exécute jusqu'au
+         * dernier micro-op qui tient, en posant temporairement un STOP sur le
+         * suivant (restauré en sortie). Le chemin courant reste sans test.
+         * Même règle que espgotchi_cpu_fast_run() : une instruction démarre
+         * tant que acc < tick_limit. Une paire fusionnée qui ne tient pas
+         * entière est remplacée par sa première instruction, suivie d'un STOP. */
+        if (count + blk->len > max_instr || acc + blk->cycles > tick_limit) {
+            for (k = 0; k < blk->uop_count; ++k) {
+                const bool_t last = (k + 1 == blk->uop_count);
+                const u32_t ticks_after = last ? blk->cycles : u[k + 1].ticks;
+                const u32_t instr_after = last ? blk->len : u[k + 1].idx;
+                if (count + u[k].idx + 1 > max_instr || acc + u[k].ticks >= tick_limit) {
+                    break;
+                }
+                if ((instr_after - u[k].idx) > 1 &&
+                    (count + instr_after > max_instr || acc + ticks_after > tick_limit)) {
+                    split = 1;
+                    break;
+                }
+            }
+            if (k < blk->uop_count) {
+                patched = &s_uops[blk->first_uop + k];
+                patched_save[0] = patched[0];
+                if (split) {
+                    const espgotchi_decoded_op_t *d = &espgotchi_get_tama_decoded_program()[blk_start + patched->idx];
+                    patched_save[1] = patched[1];
+                    patched[0].kind = d->kind;
+                    patched[0].arg0 = d->arg0;
+                    patched[0].arg1 = d->arg1;
+                    patched[1].kind = ESPGOTCHI_OP_STOP_SPLIT;
+                } else {
+                    patched[0].kind = ESPGOTCHI_OP_STOP;
+                }
+            }
+        }
+
+        arg0 = u->arg0;
+        arg1 = u->arg1;
+
+#if defined(__GNUC__)
+        goto *s_dispatch[u->kind];
+#else
+dispatch:
+        switch (u->kind)
+#endif
+        {
+#include "espgotchi_cpu_ops.inc"
+
+        /* Super-instructions : si seule la seconde moitié touche l'IO, la
+         * première est appliquée puis on s'arrête entre les deux. */
+        OP(LBPX_LBPX)
+            if (!MEM_OK(x) || !MEM_OK(x + 1)) FALLBACK();
+            SET_M(x, arg0 & 0xF);
+            SET_M(x + 1, (arg0 >> 4) & 0xF);
+            x = ((x + 2) & 0xFF) | (XP << 8);
+            if (!MEM_OK(x) || !MEM_OK(x + 1)) FALLBACK_SECOND();
+            SET_M(x, arg1 & 0xF);
+            SET_M(x + 1, (arg1 >> 4) & 0xF);
+            x = ((x + 2) & 0xFF) | (XP << 8);
+            NEXT();
+
+        OP(INC_X_LDPY_R)
+            x = ((x + 1) & 0xFF) | (XP << 8);
+            if (!RQ_OK(arg0) || !RQ_OK(arg1)) FALLBACK_SECOND();
+            SET_RQ(arg0, RQ(arg1));
+            y = ((y + 1) & 0xFF) | (YP << 8);
+            NEXT();
+
+        OP(LDPY_R_INC_X)
+            if (!RQ_OK(arg0) || !RQ_OK(arg1)) FALLBACK();
+            SET_RQ(arg0, RQ(arg1));
+            y = ((y + 1) & 0xFF) | (YP << 8);
+            x = ((x + 1) & 0xFF) | (XP << 8);
+            NEXT();
+
+        OP(LD_R_I_LD_XP_R)
+            if (!RQ_OK(arg0)) FALLBACK();
+            SET_RQ(arg0, arg1);
+            if (!RQ_OK(u->arg2)) FALLBACK_SECOND();
+            x = XHL | (RQ(u->arg2) << 8);
+            NEXT();
+
+        OP(LD_X_ADD_R_I)
+            x = arg0 | (XP << 8);
+            if (!RQ_OK(arg1)) FALLBACK_SECOND();
+            arg0 = arg1;
+            tmp = RQ(arg0) + u->arg2;
+            ADD_COMMON();
+            NEXT();
+
+        OP(LD_XP_R_LD_X)
+            if (!RQ_OK(arg0)) FALLBACK();
+            x = arg1 | (RQ(arg0) << 8);
+            NEXT();
+
+        OP(LD_X_LD_R_Q)
+            x = arg0 | (XP << 8);
+            if (!RQ_OK(arg1) || !RQ_OK(u->arg2)) FALLBACK_SECOND();
+            SET_RQ(arg1, RQ(u->arg2));
+            NEXT();
+
+        OP(EXIT)
+            /* Bloc coupé sans saut : on continue à l'adresse suivante */
+            next_pc = CUR_PC;
+            if (u->flags & UOP_NP_LIVE) {
+                /* Dernière instruction = PSET : NP conservé */
+                pc = next_pc;
+                count += blk->len;
+                acc += blk->cycles;
+                ESPGOTCHI_PROFILE_RANGE(blk_start, blk->len);
+                goto chain;
+            }
+            goto branch_done;
+
+        OP(STOP_SPLIT)
+            /* Première moitié déjà faite (et tracée) par le micro-op précédent */
+            u--;
+            goto stop_after_first;
+
+        OP(STOP)
+#if !defined(__GNUC__)
+        default:
+#endif
+        L_UNKNOWN:
+            FALLBACK();
+        }
+
+branch_done:
+        pc = next_pc;
+        np = (pc >> 8) & 0x1F;
+        count += blk->len;
+        acc += blk->cycles;
+        ESPGOTCHI_PROFILE_RANGE(blk_start, blk->len);
+
+chain:
+        /* Chaînage : successeur déjà résolu pour cette cible ? */
+        if (next_pc == blk->link_pc[0] && blk->link[0] != BLOCK_NONE) {
+            bi = blk->link[0];
+        } else if (next_pc == blk->link_pc[1] && blk->link[1] != BLOCK_NONE) {
+            bi = blk->link[1];
+        } else {
+            bi = espgotchi_block_lookup(next_pc);
+            if (bi >= BLOCK_UNTRANSLATABLE) {
+                goto out;
+            }
+            slot = (next_pc == blk->link_pc[0]) ? 0 : 1;
+            blk->link_pc[slot] = next_pc;
+            blk->link[slot] = bi;
+        }
+        blk = &s_blocks[bi];
+    }
+    goto out;
+
+stop_after_first:
+    /* Paire fusionnée coupée en deux : la première instruction est faite */
+    pc = (CUR_PC + 1) & 0x1FFF;
+    np = (pc >> 8) & 0x1F;
+    count += u->idx + 1;
+    acc += u->ticks + espgotchi_get_tama_decoded_program()[CUR_PC].cycles;
+    ESPGOTCHI_PROFILE_RANGE(blk_start, u->idx + 1);
+    goto out;
+
+stop_in_block:
+    /* Abandon avant le micro-op u : état = instructions précédentes du bloc */
+    pc = CUR_PC;
+    if (!(u->flags & UOP_NP_LIVE)) {
+        np = (pc >> 8) & 0x1F;
+    }
+    count += u->idx;
+    acc += u->ticks;
+    ESPGOTCHI_PROFILE_RANGE(blk_start, u->idx);
+
+out:
+    if (patched != NULL) {
+        patched[0] = patched_save[0];
+        if (split) {
+            patched[1] = patched_save[1];
+        }
+    }
+
+    *st->pc = pc;
+    *st->x = x;
+    *st->y = y;
+    *st->a = a;
+    *st->b = b;
+    *st->np = np;
+    *st->sp = sp;
+    *st->flags = flags;
+    *st->call_depth = depth;
+    *st->tick_counter += acc;
+
+    *ticks = acc;
+    return count;
+}
@@ -0,0 +1,58 @@
+#ifndef _ESPGOTCHI_BLOCK_CACHE_H_
+#define _ESPGOTCHI_BLOCK_CACHE_H_
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Capacité du cache de blocs (surchargeable via build_flags).
+ * Par défaut : 1024 blocs + 4096 micro-ops, ~60 Ko avec l'index par adresse,
+ * alloués via g_hal->malloc (PSRAM si disponible, sinon heap interne).
+ * La ROM P1 en utilise ~1000 blocs / ~4800 micro-ops sur 1h30 émulée : le
+ * cache se vide alors une ou deux fois, ce qui ne coûte qu'une retraduction.
+ */
+#ifndef ESPGOTCHI_BLOCK_CACHE_BLOCKS
+#define ESPGOTCHI_BLOCK_CACHE_BLOCKS 1024
+#endif
+
+#ifndef ESPGOTCHI_BLOCK_CACHE_UOPS
+#define ESPGOTCHI_BLOCK_CACHE_UOPS 4096
+#endif
+
+/* Longueur maximale d'un bloc, en instructions ROM */
+#define ESPGOTCHI_BLOCK_MAX_INSTR 32
+
+typedef struct {
+    u32_t blocks;       /* blocs actuellement traduits */
+    u32_t uops;         /* micro-ops utilisés */
+    u32_t fused;        /* super-instructions émises */
+    u32_t translations; /* traductions depuis le démarrage */
+    u32_t flushes;      /* vidages (cache plein ou programme rechargé) */
+} espgotchi_block_cache_stats_t;
+
+/*
+ * Exécute des blocs de base traduits (micro-ops + super-instructions, blocs
+ * chaînés entre eux) jusqu'à la prochaine échéance de timer ou max_instr ;
+ * le dernier bloc peut être coupé en cours de route.
+ *
+ * Mêmes règles de repli que espgotchi_cpu_fast_run() : retourne 0 quand
+ * l'instruction suivante doit passer par espgotchi_sched_step().
+ * *ticks reçoit les ticks 32 kHz consommés (déjà ajoutés à tick_counter).
+ */
+u32_t espgotchi_block_run(u32_t max_instr, u32_t *ticks);
+
+/* Oublie toutes les traductions (à appeler si le programme change).
+ * La traduction ne dépend que de la ROM : ni reset CPU ni restauration
+ * d'état ne l'invalident.
+ */
+void espgotchi_block_cache_flush(void);
+
+void espgotchi_block_cache_get_stats(espgotchi_block_cache_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_BLOCK_CACHE_H_ */
@@ -0,0 +1,147 @@
+#include "espgotchi_cpu_fast.h"
+#include "espgotchi_tama_rom.h"
+#include "espgotchi_cpu_ops.h"
+#include "espgotchi_sched.h"
+#include "espgotchi_profile.h"
+#include "espgotchi_trace.h"
+
+/*
+ * Exécution directe du programme pré-décodé
+ * -----------------------------------------
+ * Même sémantique que les callbacks de cpu.c (TamaLIB), mais :
+ *  - plus de recherche linéaire dans la table d'opcodes (décodage fait au
+ *    dépackage de la ROM),
+ *  - dispatch par table de labels (computed goto) quand le compilateur le
+ *    permet, switch sinon,
+ *  - registres en variables locales, réécrits dans state_t en sortie.
+ *
+ * Comptage des ticks : chaque durée est ajoutée tout de suite, et le lot
+ * s'arrête au budget fixé par l'ordonnanceur (espgotchi_sched.c), juste
+ * avant l'instruction qui doit servir la prochaine échéance de timer.
+ */
+
+#define CUR_PC          pc
+#define NP              np
+
+/* Sortie du lot avant l'instruction courante (aucun effet de bord appliqué) */
+#define FALLBACK()      goto stop
+#define NEXT()          goto done
+#define BRANCH()        goto done
+#define PSET_NEXT()     goto pset_done
+
+#if defined(__GNUC__)
+#define OP(kind)        L_##kind:
+#define DISPATCH(kind)  goto *s_dispatch[kind];
+#else
+#define OP(kind)        case ESPGOTCHI_OP_##kind:
+#define DISPATCH(kind)  switch (kind)
+#endif
+
+u32_t espgotchi_cpu_fast_run(u32_t max_instr, u32_t *ticks)
+{
+    state_t *st = cpu_get_state();
+    const espgotchi_decoded_op_t *const prog = espgotchi_get_tama_decoded_program();
+    const u32_t prog_words = espgotchi_get_tama_program_word_count();
+    MEM_BUFFER_TYPE *const mem = st->memory;
+    bool_t int_pending = 0;
+    u32_t tick_limit;
+    u32_t count = 0, acc = 0;
+    u32_t depth;
+    u13_t pc, next_pc, tmp_pc;
+    u12_t x, y;
+    u4_t a, b, flags;
+    u5_t np;
+    u8_t sp, tmp, arg0, arg1;
+    const espgotchi_decoded_op_t *op;
+    u8_t i;
+
+#if defined(__GNUC__)
+    static const void *const s_dispatch[ESPGOTCHI_OP_COUNT] = {
+#define ESPGOTCHI_OP_LABEL(kind, code, mask, shift, mask_arg0, cycles, name) [ESPGOTCHI_OP_##kind] = &&L_##kind,
+        ESPGOTCHI_OP_LIST(ESPGOTCHI_OP_LABEL)
+#undef ESPGOTCHI_OP_LABEL
+        [ESPGOTCHI_OP_UNKNOWN] = &&L_UNKNOWN,
+    };
+#endif
+
+    *ticks = 0;
+
+    if (*st->cpu_halted) {
+        return 0;
+    }
+
+    tick_limit = espgotchi_sched_budget();
+    if (tick_limit == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < INT_SLOT_NUM; ++i) {
+        int_pending |= st->interrupts[i].triggered;
+    }
+
+    flags = *st->flags;
+    if ((flags & FLAG_I) && int_pending) {
+        /* Interruption à servir : c'est le travail de cpu_step() */
+        return 0;
+    }
+
+    pc = *st->pc;
+    x = *st->x;
+    y = *st->y;
+    a = *st->a;
+    b = *st->b;
+    np = *st->np;
+    sp = *st->sp;
+    depth = *st->call_depth;
+
+    while (count < max_instr && acc < tick_limit && pc < prog_words) {
+        op = &prog[pc];
+        arg0 = op->arg0;
+        arg1 = op->arg1;
+        next_pc = (pc + 1) & 0x1FFF;
+
+        DISPATCH(op->kind)
+        {
+#include "espgotchi_cpu_ops.inc"
+
+#if !defined(__GNUC__)
+        case ESPGOTCHI_OP_UNKNOWN:
+        default:
+#endif
+        L_UNKNOWN:
+            FALLBACK();
+        }
+
+pset_done:
+        /* PSET est la seule instruction qui conserve NP */
+        ESPGOTCHI_PROFILE_PC(pc);
+        ESPGOTCHI_TRACE_OP(pc, ESPGOTCHI_TRACE_DECODED, a, b, sp, x, y, flags);
+        pc = next_pc;
+        acc += op->cycles;
+        count++;
+        continue;
+
+done:
+        ESPGOTCHI_PROFILE_PC(pc);
+        ESPGOTCHI_TRACE_OP(pc, ESPGOTCHI_TRACE_DECODED, a, b, sp, x, y, flags);
+        pc = next_pc;
+        np = (pc >> 8) & 0x1F;
+        acc += op->cycles;
+        count++;
+    }
+
+stop:
+    *st->pc = pc;
+    *st->x = x;
+    *st->y = y;
+    *st->a = a;
+    *st->b = b;
+    *st->np = np;
+    *st->sp = sp;
+    *st->flags = flags;
+    *st->call_depth = depth;
+    *st->tick_counter += acc;
+
+    *ticks = acc;
+    return count;
+}
@@ -0,0 +1,37 @@
+#ifndef _ESPGOTCHI_CPU_FAST_H_
+#define _ESPGOTCHI_CPU_FAST_H_
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Moteurs d'exécution CPU disponibles côté Espgotchi */
+typedef enum {
+    ESPGOTCHI_ENGINE_TAMALIB = 0, /* cpu_step() seul : interpréteur de référence */
+    ESPGOTCHI_ENGINE_DECODED = 1, /* programme pré-décodé + dispatch direct */
+    ESPGOTCHI_ENGINE_BLOCK = 2,   /* blocs de base traduits + super-instructions */
+} espgotchi_engine_t;
+
+/*
+ * Exécute au plus max_instr instructions directement sur l'état TamaLIB
+ * (cpu_get_state()), à partir du programme pré-décodé.
+ *
+ * S'arrête (sans effet de bord) avant toute instruction que seul cpu_step()
+ * sait traiter fidèlement : accès aux registres IO, HALT/SLP, opcode
+ * inconnu, ou instruction pouvant démasquer une interruption en attente.
+ * S'arrête aussi au budget de l'ordonnanceur (espgotchi_sched_budget()),
+ * pour que timers et interruptions se déclenchent à la même instruction
+ * qu'avec cpu_step().
+ *
+ * Retourne le nombre d'instructions exécutées (0 : espgotchi_sched_step()).
+ * *ticks reçoit les ticks 32 kHz consommés (déjà ajoutés à tick_counter).
+ */
+u32_t espgotchi_cpu_fast_run(u32_t max_instr, u32_t *ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_CPU_FAST_H_ */
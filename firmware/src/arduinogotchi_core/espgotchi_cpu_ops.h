@@ -0,0 +1,127 @@
+#ifndef _ESPGOTCHI_CPU_OPS_H_
+#define _ESPGOTCHI_CPU_OPS_H_
+
+/*
+ * Macros privées des moteurs CPU Espgotchi (espgotchi_cpu_fast.c,
+ * espgotchi_block_cache.c) : mêmes noms et mêmes formules que cpu.c,
+ * appliquées à des registres locaux (pc, x, y, a, b, np, sp, flags, mem).
+ * À utiliser avec espgotchi_cpu_ops.inc.
+ */
+
+#include "cpu.h"
+#include "hw.h"
+#include "espgotchi_lcd.h"
+
+#define FLAG_C (0x1 << 0)
+#define FLAG_Z (0x1 << 1)
+#define FLAG_D (0x1 << 2)
+#define FLAG_I (0x1 << 3)
+
+#define TO_PC(bank, page, step) (((step) & 0xFF) | (((page) & 0xF) << 8) | ((bank) & 0x1) << 12)
+
+#define XHL     (x & 0xFF)
+#define XL      (x & 0xF)
+#define XH      ((x >> 4) & 0xF)
+#define XP      ((x >> 8) & 0xF)
+#define YHL     (y & 0xFF)
+#define YL      (y & 0xF)
+#define YH      ((y >> 4) & 0xF)
+#define YP      ((y >> 8) & 0xF)
+#define SPL     (sp & 0xF)
+#define SPH     ((sp >> 4) & 0xF)
+
+#define C       (!!(flags & FLAG_C))
+#define D       (!!(flags & FLAG_D))
+#define SET_C_IF(cond)  do { if (cond) flags |= FLAG_C; else flags &= ~FLAG_C; } while (0)
+#define SET_Z_IF(cond)  do { if (cond) flags |= FLAG_Z; else flags &= ~FLAG_Z; } while (0)
+
+/* Accès mémoire : RAM et mémoire d'affichage ; les registres IO (effets de
+ * bord sur timers, interruptions, boutons) passent par cpu_step().
+ * Les adresses sont tronquées en u12_t comme dans get_memory()/set_memory().
+ */
+#define DISP_OK(n) \
+    (((n) >= MEM_DISPLAY1_ADDR && (n) < MEM_DISPLAY1_ADDR + MEM_DISPLAY1_SIZE) || \
+     ((n) >= MEM_DISPLAY2_ADDR && (n) < MEM_DISPLAY2_ADDR + MEM_DISPLAY2_SIZE))
+#define MEM_OK(n)       ((u12_t)(n) < MEM_RAM_SIZE || DISP_OK((u12_t)(n)))
+#define M(n)            espgotchi_ops_get_memory(mem, (u12_t)(n))
+#define SET_M(n, v)     espgotchi_ops_set_memory(mem, (u12_t)(n), v)
+
+static inline u4_t espgotchi_ops_get_memory(const MEM_BUFFER_TYPE *mem, u12_t n)
+{
+    if (n < MEM_RAM_SIZE) {
+        return GET_RAM_MEMORY(mem, n);
+    }
+    if (n < MEM_DISPLAY2_ADDR) {
+        return GET_DISP1_MEMORY(mem, n);
+    }
+    return GET_DISP2_MEMORY(mem, n);
+}
+
+/* set_memory() + set_lcd() de cpu.c pour les adresses validées par MEM_OK() */
+static inline void espgotchi_ops_set_memory(MEM_BUFFER_TYPE *mem, u12_t n, u4_t v)
+{
+    u8_t seg, com0, i;
+
+    if (n < MEM_RAM_SIZE) {
+        SET_RAM_MEMORY(mem, n, v);
+        return;
+    }
+    if (n < MEM_DISPLAY2_ADDR) {
+        SET_DISP1_MEMORY(mem, n, v);
+    } else {
+        SET_DISP2_MEMORY(mem, n, v);
+    }
+
+    /* Mode paresseux : décodé à la prochaine trame (espgotchi_lcd.c) */
+    if (espgotchi_lcd_lazy) {
+        espgotchi_lcd_dirty = 1;
+        return;
+    }
+
+    seg = ((n & 0x7F) >> 1);
+    com0 = (((n & 0x80) >> 7) * 8 + (n & 0x1) * 4);
+    for (i = 0; i < 4; i++) {
+        hw_set_lcd_pin(seg, com0 + i, (v >> i) & 0x1);
+    }
+}
+
+#define RQ_OK_XY(r, xv, yv) ((r) < 2 || MEM_OK(((r) == 2) ? (xv) : (yv)))
+#define RQ_OK(r)        RQ_OK_XY(r, x, y)
+#define RQ(r)           ((r) == 0 ? a : (r) == 1 ? b : (r) == 2 ? M(x) : M(y))
+#define SET_RQ(r, v) \
+    do { \
+        u4_t v_ = (u4_t)(v); \
+        switch ((r) & 0x3) { \
+        case 0x0: a = v_; break; \
+        case 0x1: b = v_; break; \
+        case 0x2: SET_M(x, v_); break; \
+        default:  SET_M(y, v_); break; \
+        } \
+    } while (0)
+
+/* add_common() / sub_common() de cpu.c (mode décimal compris), sur tmp/arg0 */
+#define ADD_COMMON() \
+    do { \
+        if (D) { \
+            if (tmp >= 10) { SET_RQ(arg0, (tmp - 10) & 0xF); flags |= FLAG_C; } \
+            else { SET_RQ(arg0, tmp); flags &= ~FLAG_C; } \
+        } else { \
+            SET_RQ(arg0, tmp & 0xF); \
+            SET_C_IF(tmp >> 4); \
+        } \
+        SET_Z_IF(!RQ(arg0)); \
+    } while (0)
+
+#define SUB_COMMON() \
+    do { \
+        if (D) { \
+            if (tmp >> 4) { SET_RQ(arg0, (tmp - 6) & 0xF); } \
+            else { SET_RQ(arg0, tmp); } \
+        } else { \
+            SET_RQ(arg0, tmp & 0xF); \
+        } \
+        SET_C_IF(tmp >> 4); \
+        SET_Z_IF(!RQ(arg0)); \
+    } while (0)
+
+#endif /* _ESPGOTCHI_CPU_OPS_H_ */
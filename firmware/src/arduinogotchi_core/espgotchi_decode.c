@@ -0,0 +1,69 @@
+#include "espgotchi_decode.h"
+
+/*
+ * Décodeur E0C6S46 utilisé au dépackage de la ROM
+ * -----------------------------------------------
+ * Reproduit la recherche linéaire de cpu_step() (premier masque qui matche),
+ * mais une seule fois par mot ROM au lieu d'une fois par instruction exécutée.
+ */
+
+typedef struct {
+    u12_t code;
+    u12_t mask;
+    u8_t shift_arg0;
+    u12_t mask_arg0;
+    u8_t cycles;
+} espgotchi_op_desc_t;
+
+static const espgotchi_op_desc_t s_ops[ESPGOTCHI_OP_UNKNOWN] = {
+#define ESPGOTCHI_OP_DESC(kind, code, mask, shift, mask_arg0, cycles, name) {code, mask, shift, mask_arg0, cycles},
+    ESPGOTCHI_OP_LIST(ESPGOTCHI_OP_DESC)
+#undef ESPGOTCHI_OP_DESC
+};
+
+static const char *const s_op_names[ESPGOTCHI_OP_UNKNOWN] = {
+#define ESPGOTCHI_OP_NAME(kind, code, mask, shift, mask_arg0, cycles, name) name,
+    ESPGOTCHI_OP_LIST(ESPGOTCHI_OP_NAME)
+#undef ESPGOTCHI_OP_NAME
+};
+
+void espgotchi_decode_op(u12_t op, espgotchi_decoded_op_t *out)
+{
+    u8_t i;
+
+    for (i = 0; i < ESPGOTCHI_OP_UNKNOWN; ++i) {
+        if ((op & s_ops[i].mask) == s_ops[i].code) {
+            break;
+        }
+    }
+
+    out->kind = i;
+
+    if (i == ESPGOTCHI_OP_UNKNOWN) {
+        out->arg0 = 0;
+        out->arg1 = 0;
+        out->cycles = 0;
+        return;
+    }
+
+    out->cycles = s_ops[i].cycles;
+
+    if (s_ops[i].mask_arg0 != 0) {
+        /* Deux arguments */
+        out->arg0 = (u8_t)((op & s_ops[i].mask_arg0) >> s_ops[i].shift_arg0);
+        out->arg1 = (u8_t)(op & ~(s_ops[i].mask | s_ops[i].mask_arg0));
+    } else {
+        /* Un seul argument */
+        out->arg0 = (u8_t)((op & ~s_ops[i].mask) >> s_ops[i].shift_arg0);
+        out->arg1 = 0;
+    }
+}
+
+const char *espgotchi_op_name(u8_t kind)
+{
+    if (kind >= ESPGOTCHI_OP_UNKNOWN) {
+        return "?";
+    }
+
+    return s_op_names[kind];
+}
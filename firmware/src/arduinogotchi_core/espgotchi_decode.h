@@ -0,0 +1,147 @@
+#ifndef _ESPGOTCHI_DECODE_H_
+#define _ESPGOTCHI_DECODE_H_
+
+#include "../../lib/hal_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Jeu d'instructions E0C6S46 tel que décodé par TamaLIB (cpu.c, table ops[]).
+ * Même ordre, mêmes masques, même extraction d'arguments, mêmes cycles :
+ * la première entrée qui matche gagne, exactement comme dans cpu_step().
+ * (SCF/RCF/EI/DI... sont absorbés par SET/RST qui les précèdent dans TamaLIB.)
+ *
+ * X(kind, code, mask, shift_arg0, mask_arg0, cycles, mnemonic)
+ */
+#define ESPGOTCHI_OP_LIST(X) \
+    X(PSET,     0xE40, 0xFE0, 0, 0x000,  5, "PSET")     \
+    X(JP,       0x000, 0xF00, 0, 0x000,  5, "JP")       \
+    X(JP_C,     0x200, 0xF00, 0, 0x000,  5, "JP C")     \
+    X(JP_NC,    0x300, 0xF00, 0, 0x000,  5, "JP NC")    \
+    X(JP_Z,     0x600, 0xF00, 0, 0x000,  5, "JP Z")     \
+    X(JP_NZ,    0x700, 0xF00, 0, 0x000,  5, "JP NZ")    \
+    X(JPBA,     0xFE8, 0xFFF, 0, 0x000,  5, "JPBA")     \
+    X(CALL,     0x400, 0xF00, 0, 0x000,  7, "CALL")     \
+    X(CALZ,     0x500, 0xF00, 0, 0x000,  7, "CALZ")     \
+    X(RET,      0xFDF, 0xFFF, 0, 0x000,  7, "RET")      \
+    X(RETS,     0xFDE, 0xFFF, 0, 0x000, 12, "RETS")     \
+    X(RETD,     0x100, 0xF00, 0, 0x000, 12, "RETD")     \
+    X(NOP5,     0xFFB, 0xFFF, 0, 0x000,  5, "NOP5")     \
+    X(NOP7,     0xFFF, 0xFFF, 0, 0x000,  7, "NOP7")     \
+    X(HALT,     0xFF8, 0xFFF, 0, 0x000,  5, "HALT")     \
+    X(SLP,      0xFF9, 0xFFF, 0, 0x000,  5, "SLP")      \
+    X(INC_X,    0xEE0, 0xFFF, 0, 0x000,  5, "INC X")    \
+    X(INC_Y,    0xEF0, 0xFFF, 0, 0x000,  5, "INC Y")    \
+    X(LD_X,     0xB00, 0xF00, 0, 0x000,  5, "LD X")     \
+    X(LD_Y,     0x800, 0xF00, 0, 0x000,  5, "LD Y")     \
+    X(LD_XP_R,  0xE80, 0xFFC, 0, 0x000,  5, "LD XP,r")  \
+    X(LD_XH_R,  0xE84, 0xFFC, 0, 0x000,  5, "LD XH,r")  \
+    X(LD_XL_R,  0xE88, 0xFFC, 0, 0x000,  5, "LD XL,r")  \
+    X(LD_YP_R,  0xE90, 0xFFC, 0, 0x000,  5, "LD YP,r")  \
+    X(LD_YH_R,  0xE94, 0xFFC, 0, 0x000,  5, "LD YH,r")  \
+    X(LD_YL_R,  0xE98, 0xFFC, 0, 0x000,  5, "LD YL,r")  \
+    X(LD_R_XP,  0xEA0, 0xFFC, 0, 0x000,  5, "LD r,XP")  \
+    X(LD_R_XH,  0xEA4, 0xFFC, 0, 0x000,  5, "LD r,XH")  \
+    X(LD_R_XL,  0xEA8, 0xFFC, 0, 0x000,  5, "LD r,XL")  \
+    X(LD_R_YP,  0xEB0, 0xFFC, 0, 0x000,  5, "LD r,YP")  \
+    X(LD_R_YH,  0xEB4, 0xFFC, 0, 0x000,  5, "LD r,YH")  \
+    X(LD_R_YL,  0xEB8, 0xFFC, 0, 0x000,  5, "LD r,YL")  \
+    X(ADC_XH,   0xA00, 0xFF0, 0, 0x000,  7, "ADC XH")   \
+    X(ADC_XL,   0xA10, 0xFF0, 0, 0x000,  7, "ADC XL")   \
+    X(ADC_YH,   0xA20, 0xFF0, 0, 0x000,  7, "ADC YH")   \
+    X(ADC_YL,   0xA30, 0xFF0, 0, 0x000,  7, "ADC YL")   \
+    X(CP_XH,    0xA40, 0xFF0, 0, 0x000,  7, "CP XH")    \
+    X(CP_XL,    0xA50, 0xFF0, 0, 0x000,  7, "CP XL")    \
+    X(CP_YH,    0xA60, 0xFF0, 0, 0x000,  7, "CP YH")    \
+    X(CP_YL,    0xA70, 0xFF0, 0, 0x000,  7, "CP YL")    \
+    X(LD_R_I,   0xE00, 0xFC0, 4, 0x030,  5, "LD r,i")   \
+    X(LD_R_Q,   0xEC0, 0xFF0, 2, 0x00C,  5, "LD r,q")   \
+    X(LD_A_MN,  0xFA0, 0xFF0, 0, 0x000,  5, "LD A,Mn")  \
+    X(LD_B_MN,  0xFB0, 0xFF0, 0, 0x000,  5, "LD B,Mn")  \
+    X(LD_MN_A,  0xF80, 0xFF0, 0, 0x000,  5, "LD Mn,A")  \
+    X(LD_MN_B,  0xF90, 0xFF0, 0, 0x000,  5, "LD Mn,B")  \
+    X(LDPX_MX,  0xE60, 0xFF0, 0, 0x000,  5, "LDPX MX")  \
+    X(LDPX_R,   0xEE0, 0xFF0, 2, 0x00C,  5, "LDPX r,q") \
+    X(LDPY_MY,  0xE70, 0xFF0, 0, 0x000,  5, "LDPY MY")  \
+    X(LDPY_R,   0xEF0, 0xFF0, 2, 0x00C,  5, "LDPY r,q") \
+    X(LBPX,     0x900, 0xF00, 0, 0x000,  5, "LBPX")     \
+    X(SET,      0xF40, 0xFF0, 0, 0x000,  7, "SET F")    \
+    X(RST,      0xF50, 0xFF0, 0, 0x000,  7, "RST F")    \
+    X(INC_SP,   0xFDB, 0xFFF, 0, 0x000,  5, "INC SP")   \
+    X(DEC_SP,   0xFCB, 0xFFF, 0, 0x000,  5, "DEC SP")   \
+    X(PUSH_R,   0xFC0, 0xFFC, 0, 0x000,  5, "PUSH r")   \
+    X(PUSH_XP,  0xFC4, 0xFFF, 0, 0x000,  5, "PUSH XP")  \
+    X(PUSH_XH,  0xFC5, 0xFFF, 0, 0x000,  5, "PUSH XH")  \
+    X(PUSH_XL,  0xFC6, 0xFFF, 0, 0x000,  5, "PUSH XL")  \
+    X(PUSH_YP,  0xFC7, 0xFFF, 0, 0x000,  5, "PUSH YP")  \
+    X(PUSH_YH,  0xFC8, 0xFFF, 0, 0x000,  5, "PUSH YH")  \
+    X(PUSH_YL,  0xFC9, 0xFFF, 0, 0x000,  5, "PUSH YL")  \
+    X(PUSH_F,   0xFCA, 0xFFF, 0, 0x000,  5, "PUSH F")   \
+    X(POP_R,    0xFD0, 0xFFC, 0, 0x000,  5, "POP r")    \
+    X(POP_XP,   0xFD4, 0xFFF, 0, 0x000,  5, "POP XP")   \
+    X(POP_XH,   0xFD5, 0xFFF, 0, 0x000,  5, "POP XH")   \
+    X(POP_XL,   0xFD6, 0xFFF, 0, 0x000,  5, "POP XL")   \
+    X(POP_YP,   0xFD7, 0xFFF, 0, 0x000,  5, "POP YP")   \
+    X(POP_YH,   0xFD8, 0xFFF, 0, 0x000,  5, "POP YH")   \
+    X(POP_YL,   0xFD9, 0xFFF, 0, 0x000,  5, "POP YL")   \
+    X(POP_F,    0xFDA, 0xFFF, 0, 0x000,  5, "POP F")    \
+    X(LD_SPH_R, 0xFE0, 0xFFC, 0, 0x000,  5, "LD SPH,r") \
+    X(LD_SPL_R, 0xFF0, 0xFFC, 0, 0x000,  5, "LD SPL,r") \
+    X(LD_R_SPH, 0xFE4, 0xFFC, 0, 0x000,  5, "LD r,SPH") \
+    X(LD_R_SPL, 0xFF4, 0xFFC, 0, 0x000,  5, "LD r,SPL") \
+    X(ADD_R_I,  0xC00, 0xFC0, 4, 0x030,  7, "ADD r,i")  \
+    X(ADD_R_Q,  0xA80, 0xFF0, 2, 0x00C,  7, "ADD r,q")  \
+    X(ADC_R_I,  0xC40, 0xFC0, 4, 0x030,  7, "ADC r,i")  \
+    X(ADC_R_Q,  0xA90, 0xFF0, 2, 0x00C,  7, "ADC r,q")  \
+    X(SUB,      0xAA0, 0xFF0, 2, 0x00C,  7, "SUB r,q")  \
+    X(SBC_R_I,  0xD40, 0xFC0, 4, 0x030,  7, "SBC r,i")  \
+    X(SBC_R_Q,  0xAB0, 0xFF0, 2, 0x00C,  7, "SBC r,q")  \
+    X(AND_R_I,  0xC80, 0xFC0, 4, 0x030,  7, "AND r,i")  \
+    X(AND_R_Q,  0xAC0, 0xFF0, 2, 0x00C,  7, "AND r,q")  \
+    X(OR_R_I,   0xCC0, 0xFC0, 4, 0x030,  7, "OR r,i")   \
+    X(OR_R_Q,   0xAD0, 0xFF0, 2, 0x00C,  7, "OR r,q")   \
+    X(XOR_R_I,  0xD00, 0xFC0, 4, 0x030,  7, "XOR r,i")  \
+    X(XOR_R_Q,  0xAE0, 0xFF0, 2, 0x00C,  7, "XOR r,q")  \
+    X(CP_R_I,   0xDC0, 0xFC0, 4, 0x030,  7, "CP r,i")   \
+    X(CP_R_Q,   0xF00, 0xFF0, 2, 0x00C,  7, "CP r,q")   \
+    X(FAN_R_I,  0xD80, 0xFC0, 4, 0x030,  7, "FAN r,i")  \
+    X(FAN_R_Q,  0xF10, 0xFF0, 2, 0x00C,  7, "FAN r,q")  \
+    X(RLC,      0xAF0, 0xFF0, 2, 0x000,  7, "RLC r")    \
+    X(RRC,      0xE8C, 0xFFC, 0, 0x000,  5, "RRC r")    \
+    X(INC_MN,   0xF60, 0xFF0, 0, 0x000,  7, "INC Mn")   \
+    X(DEC_MN,   0xF70, 0xFF0, 0, 0x000,  7, "DEC Mn")   \
+    X(ACPX,     0xF28, 0xFFC, 0, 0x000,  7, "ACPX r")   \
+    X(ACPY,     0xF2C, 0xFFC, 0, 0x000,  7, "ACPY r")   \
+    X(SCPX,     0xF38, 0xFFC, 0, 0x000,  7, "SCPX r")   \
+    X(SCPY,     0xF3C, 0xFFC, 0, 0x000,  7, "SCPY r")   \
+    X(NOT,      0xD0F, 0xFCF, 4, 0x000,  7, "NOT r")
+
+typedef enum {
+#define ESPGOTCHI_OP_ENUM(kind, code, mask, shift, mask_arg0, cycles, name) ESPGOTCHI_OP_##kind,
+    ESPGOTCHI_OP_LIST(ESPGOTCHI_OP_ENUM)
+#undef ESPGOTCHI_OP_ENUM
+    ESPGOTCHI_OP_UNKNOWN, /* opcode absent de la table : cpu_step() le signalera */
+    ESPGOTCHI_OP_COUNT
+} espgotchi_op_kind_t;
+
+/* Une instruction ROM pré-décodée : 4 octets, prête pour un dispatch direct */
+typedef struct {
+    u8_t kind;   /* espgotchi_op_kind_t */
+    u8_t arg0;   /* premier argument, déjà extrait/décalé comme dans cpu_step() */
+    u8_t arg1;   /* second argument (0 si l'instruction n'en a qu'un) */
+    u8_t cycles; /* durée en ticks 32 kHz */
+} espgotchi_decoded_op_t;
+
+/* Décode un mot ROM 12 bits */
+void espgotchi_decode_op(u12_t op, espgotchi_decoded_op_t *out);
+
+/* Mnémonique d'une classe d'instruction ("?" si inconnue) */
+const char *espgotchi_op_name(u8_t kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_DECODE_H_ */
@@ -0,0 +1,93 @@
+#include <string.h>
+
+#include "espgotchi_lcd.h"
+
+/* Quartets de mémoire d'affichage : deux bancs de MEM_DISPLAY1_SIZE */
+#define LCD_VRAM_NIBBLES    (MEM_DISPLAY1_SIZE + MEM_DISPLAY2_SIZE)
+#define LCD_MAP_NONE        0xFF
+
+/* Câblage segment -> colonne de hw.c (>= LCD_WIDTH : icônes ou rien) */
+static const u8_t seg_pos[40] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 32, 8, 9, 10, 11, 12, 13, 14, 15, 33, 34, 35,
+    31, 30, 29, 28, 27, 26, 25, 24, 36, 23, 22, 21, 20, 19, 18, 17, 16, 37, 38, 39,
+};
+
+/* Un quartet = un segment sur 4 COM consécutifs : une colonne de la matrice
+ * sur 4 lignes, ou 4 icônes (segment 8 COM 0-3, segment 28 COM 12-15)
+ */
+typedef struct {
+    u8_t byte; /* x / 8, LCD_MAP_NONE si pas dans la matrice */
+    u8_t mask; /* bit de x dans l'octet */
+    u8_t com0; /* ligne du bit 0 */
+    u8_t icon; /* icône du bit 0, LCD_MAP_NONE si aucune */
+} lcd_map_t;
+
+bool_t espgotchi_lcd_lazy = ESPGOTCHI_LCD_LAZY;
+bool_t espgotchi_lcd_dirty = 1;
+
+static lcd_map_t s_map[LCD_VRAM_NIBBLES];
+static bool_t s_map_ready = 0;
+
+/* Même formule que set_lcd() (cpu.c), quartet i = adresse relative au banc */
+static void build_map(void)
+{
+    u8_t i;
+
+    for (i = 0; i < LCD_VRAM_NIBBLES; ++i) {
+        const u8_t n = (i < MEM_DISPLAY1_SIZE) ? i : (u8_t)(0x80 + i - MEM_DISPLAY1_SIZE);
+        const u8_t seg = (n & 0x7F) >> 1;
+        const u8_t com0 = ((n & 0x80) >> 7) * 8 + (n & 0x1) * 4;
+        const u8_t x = seg_pos[seg];
+        lcd_map_t *m = &s_map[i];
+
+        m->com0 = com0;
+        m->byte = LCD_MAP_NONE;
+        m->mask = 0;
+        m->icon = LCD_MAP_NONE;
+        if (x < LCD_WIDTH) {
+            m->byte = x / 8;
+            m->mask = 0x80 >> (x % 8);
+        } else if (seg == 8 && com0 == 0) {
+            m->icon = 0;
+        } else if (seg == 28 && com0 == 12) {
+            m->icon = 4;
+        }
+    }
+    s_map_ready = 1;
+}
+
+void espgotchi_lcd_set_lazy(bool_t lazy)
+{
+    espgotchi_lcd_lazy = lazy;
+    espgotchi_lcd_dirty = 1;
+}
+
+void espgotchi_lcd_decode(u8_t matrix[LCD_HEIGHT][LCD_WIDTH / 8], bool_t icons[ICON_NUM])
+{
+    const MEM_BUFFER_TYPE *mem = cpu_get_state()->memory;
+    u8_t i;
+    u8_t b, v;
+
+    if (!s_map_ready) {
+        build_map();
+    }
+
+    memset(matrix, 0, LCD_HEIGHT * (LCD_WIDTH / 8));
+    for (i = 0; i < LCD_VRAM_NIBBLES; ++i) {
+        const lcd_map_t *m = &s_map[i];
+
+        v = (i < MEM_DISPLAY1_SIZE) ? GET_DISP1_MEMORY(mem, MEM_DISPLAY1_ADDR + i)
+                                    : GET_DISP2_MEMORY(mem, MEM_DISPLAY2_ADDR + i - MEM_DISPLAY1_SIZE);
+        if (m->byte != LCD_MAP_NONE) {
+            for (b = 0; b < 4; ++b) {
+                if (v & (1 << b)) {
+                    matrix[m->com0 + b][m->byte] |= m->mask;
+                }
+            }
+        } else if (m->icon != LCD_MAP_NONE) {
+            for (b = 0; b < 4; ++b) {
+                icons[m->icon + b] = (v >> b) & 0x1;
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef _ESPGOTCHI_LCD_H_
+#define _ESPGOTCHI_LCD_H_
+
+#include "cpu.h"
+#include "hw.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Décodage paresseux de la mémoire d'affichage
+ * --------------------------------------------
+ * Par défaut, chaque écriture en mémoire d'affichage (0xE00-0xE4F,
+ * 0xE80-0xECF) appelle hw_set_lcd_pin() quatre fois, soit quatre appels
+ * indirects g_hal->set_lcd_matrix() / set_lcd_icon() jusqu'à VideoService.
+ *
+ * En mode paresseux, une écriture ne fait que lever espgotchi_lcd_dirty :
+ * les moteurs Espgotchi n'appellent plus hw_set_lcd_pin(), et les callbacks
+ * HAL appelés par cpu_step() se réduisent au même marquage. La matrice
+ * 32x16 et les icônes sont décodées d'un bloc depuis la mémoire d'affichage,
+ * une fois par trame rendue (ou par export d'état), avec une table
+ * quartet -> pixels construite une fois à partir du câblage de hw.c.
+ *
+ * ESPGOTCHI_LCD_LAZY fixe le mode au démarrage (1 par défaut) ;
+ * espgotchi_lcd_set_lazy() le change à l'exécution.
+ */
+#ifndef ESPGOTCHI_LCD_LAZY
+#define ESPGOTCHI_LCD_LAZY 1
+#endif
+
+/* Lus par les moteurs à chaque écriture d'affichage (chemin chaud) */
+extern bool_t espgotchi_lcd_lazy;
+extern bool_t espgotchi_lcd_dirty;
+
+/* Change de mode ; l'appelant décode d'abord ce qui est en attente */
+void espgotchi_lcd_set_lazy(bool_t lazy);
+
+/* Mémoire d'affichage modifiée depuis le dernier décodage : lit et efface */
+static inline bool_t espgotchi_lcd_take_dirty(void)
+{
+    const bool_t dirty = espgotchi_lcd_dirty;
+    espgotchi_lcd_dirty = 0;
+    return dirty;
+}
+
+/* Reconstruit la matrice (1 bit par pixel, MSB = x % 8 == 0, comme
+ * VideoService) et les icônes à partir de la mémoire d'affichage du CPU.
+ */
+void espgotchi_lcd_decode(u8_t matrix[LCD_HEIGHT][LCD_WIDTH / 8], bool_t icons[ICON_NUM]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_LCD_H_ */
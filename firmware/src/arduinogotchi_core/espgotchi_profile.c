@@ -0,0 +1,151 @@
+#include <string.h>
+
+#include "espgotchi_profile.h"
+#include "espgotchi_tama_rom.h"
+
+#if ESPGOTCHI_PROFILE
+
+u32_t *espgotchi_profile_pc = NULL;
+uint64_t espgotchi_profile_paths[ESPGOTCHI_PROFILE_PATH_COUNT];
+
+static u32_t s_words = 0;
+
+bool_t espgotchi_profile_begin(void)
+{
+    if (espgotchi_profile_pc == NULL) {
+        s_words = espgotchi_get_tama_program_word_count();
+        espgotchi_profile_pc = (u32_t *)g_hal->malloc(sizeof(u32_t) * s_words);
+        if (espgotchi_profile_pc == NULL) {
+            g_hal->log(LOG_ERROR, "[Profile] allocation failed, profiler disabled\n");
+            s_words = 0;
+            return 0;
+        }
+    }
+
+    espgotchi_profile_reset();
+    return 1;
+}
+
+void espgotchi_profile_reset(void)
+{
+    if (espgotchi_profile_pc != NULL) {
+        memset(espgotchi_profile_pc, 0, sizeof(u32_t) * s_words);
+    }
+    memset(espgotchi_profile_paths, 0, sizeof(espgotchi_profile_paths));
+}
+
+bool_t espgotchi_profile_enabled(void)
+{
+    return espgotchi_profile_pc != NULL;
+}
+
+void espgotchi_profile_range(u13_t start, u32_t n)
+{
+    u32_t i;
+
+    if (espgotchi_profile_pc == NULL) {
+        return;
+    }
+    for (i = 0; i < n && start + i < s_words; ++i) {
+        espgotchi_profile_pc[start + i]++;
+    }
+}
+
+u32_t espgotchi_profile_pc_count(u13_t pc)
+{
+    return (espgotchi_profile_pc != NULL && pc < s_words) ? espgotchi_profile_pc[pc] : 0;
+}
+
+void espgotchi_profile_get_ops(espgotchi_profile_op_t *out)
+{
+    const espgotchi_decoded_op_t *const prog = espgotchi_get_tama_decoded_program();
+    u32_t pc;
+
+    memset(out, 0, sizeof(espgotchi_profile_op_t) * ESPGOTCHI_OP_COUNT);
+    if (espgotchi_profile_pc == NULL || prog == NULL) {
+        return;
+    }
+
+    for (pc = 0; pc < s_words; ++pc) {
+        const u32_t n = espgotchi_profile_pc[pc];
+        out[prog[pc].kind].count += n;
+        out[prog[pc].kind].cycles += (uint64_t)n * prog[pc].cycles;
+    }
+}
+
+void espgotchi_profile_get_paths(uint64_t *out)
+{
+    memcpy(out, espgotchi_profile_paths, sizeof(espgotchi_profile_paths));
+}
+
+u32_t espgotchi_profile_top_pcs(u13_t *pcs, u32_t n)
+{
+    u32_t found = 0;
+    u32_t pc, k;
+
+    if (espgotchi_profile_pc == NULL) {
+        return 0;
+    }
+
+    /* Tri par insertion dans pcs : n reste petit (quelques dizaines) */
+    for (pc = 0; pc < s_words; ++pc) {
+        const u32_t c = espgotchi_profile_pc[pc];
+        if (c == 0 || (found == n && c <= espgotchi_profile_pc[pcs[n - 1]])) {
+            continue;
+        }
+        k = (found < n) ? found++ : n - 1;
+        while (k > 0 && espgotchi_profile_pc[pcs[k - 1]] < c) {
+            pcs[k] = pcs[k - 1];
+            k--;
+        }
+        pcs[k] = (u13_t)pc;
+    }
+    return found;
+}
+
+#else
+
+bool_t espgotchi_profile_begin(void)
+{
+    return 0;
+}
+
+void espgotchi_profile_reset(void)
+{
+}
+
+bool_t espgotchi_profile_enabled(void)
+{
+    return 0;
+}
+
+void espgotchi_profile_range(u13_t start, u32_t n)
+{
+    (void)start;
+    (void)n;
+}
+
+u32_t espgotchi_profile_pc_count(u13_t pc)
+{
+    (void)pc;
+    return 0;
+}
+
+void espgotchi_profile_get_ops(espgotchi_profile_op_t *out)
+{
+    memset(out, 0, sizeof(espgotchi_profile_op_t) * ESPGOTCHI_OP_COUNT);
+}
+
+void espgotchi_profile_get_paths(uint64_t *out)
+{
+    memset(out, 0, sizeof(uint64_t) * ESPGOTCHI_PROFILE_PATH_COUNT);
+}
+
+u32_t espgotchi_profile_top_pcs(u13_t *pcs, u32_t n)
+{
+    (void)pcs;
+    (void)n;
+    return 0;
+}
+
+#endif
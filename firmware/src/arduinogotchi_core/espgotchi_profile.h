@@ -0,0 +1,84 @@
+#ifndef _ESPGOTCHI_PROFILE_H_
+#define _ESPGOTCHI_PROFILE_H_
+
+#include "cpu.h"
+#include "espgotchi_decode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Profileur d'exécution (optionnel)
+ * ---------------------------------
+ * Compte les exécutions de chaque adresse ROM sur tous les chemins
+ * (moteurs décodé et blocs, pas TamaLIB), plus les instructions par chemin.
+ * Une adresse ROM se décode toujours en la même instruction : les
+ * exécutions et cycles par classe d'opcode s'en déduisent à la lecture,
+ * sans rien compter de plus pendant l'exécution.
+ *
+ * Compilé seulement avec -D ESPGOTCHI_PROFILE=1 : sinon les points de
+ * mesure ci-dessous sont vides et le chemin d'exécution est inchangé.
+ * Compteurs : 4 octets par mot ROM (~24 Ko pour la ROM P1), alloués par
+ * g_hal->malloc au premier espgotchi_profile_begin().
+ */
+#ifndef ESPGOTCHI_PROFILE
+#define ESPGOTCHI_PROFILE 0
+#endif
+
+typedef enum {
+    ESPGOTCHI_PROFILE_ENGINE = 0, /* instructions exécutées par un moteur Espgotchi */
+    ESPGOTCHI_PROFILE_STEP,       /* instructions passées par cpu_step() */
+    ESPGOTCHI_PROFILE_HALT,       /* pas d'arrêt (HALT/SLP) sautés */
+    ESPGOTCHI_PROFILE_PATH_COUNT
+} espgotchi_profile_path_t;
+
+typedef struct {
+    uint64_t count;  /* exécutions */
+    uint64_t cycles; /* ticks 32 kHz */
+} espgotchi_profile_op_t;
+
+#if ESPGOTCHI_PROFILE
+extern u32_t *espgotchi_profile_pc;
+extern uint64_t espgotchi_profile_paths[ESPGOTCHI_PROFILE_PATH_COUNT];
+
+#define ESPGOTCHI_PROFILE_PC(pc) \
+    do { if (espgotchi_profile_pc != NULL) espgotchi_profile_pc[pc]++; } while (0)
+#define ESPGOTCHI_PROFILE_RANGE(start, n)   espgotchi_profile_range((start), (n))
+#define ESPGOTCHI_PROFILE_PATH(path, n)     (espgotchi_profile_paths[path] += (n))
+#else
+#define ESPGOTCHI_PROFILE_PC(pc)            ((void)0)
+#define ESPGOTCHI_PROFILE_RANGE(start, n)   ((void)0)
+#define ESPGOTCHI_PROFILE_PATH(path, n)     ((void)0)
+#endif
+
+/* Alloue les compteurs (une fois) et les remet à zéro. 0 si indisponible
+ * (profileur non compilé ou allocation impossible).
+ */
+bool_t espgotchi_profile_begin(void);
+void espgotchi_profile_reset(void);
+bool_t espgotchi_profile_enabled(void);
+
+/* n instructions linéaires exécutées à partir de start (bloc de base) */
+void espgotchi_profile_range(u13_t start, u32_t n);
+
+/* Exécutions de l'adresse ROM pc depuis le dernier reset */
+u32_t espgotchi_profile_pc_count(u13_t pc);
+
+/* Agrégat par classe d'opcode, out[ESPGOTCHI_OP_COUNT] */
+void espgotchi_profile_get_ops(espgotchi_profile_op_t *out);
+
+/* Instructions par chemin, out[ESPGOTCHI_PROFILE_PATH_COUNT] */
+void espgotchi_profile_get_paths(uint64_t *out);
+
+/* Les n adresses les plus exécutées, par ordre décroissant.
+ * Retourne le nombre d'adresses écrites dans pcs (celles jamais exécutées
+ * sont omises).
+ */
+u32_t espgotchi_profile_top_pcs(u13_t *pcs, u32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_PROFILE_H_ */
@@ -0,0 +1,335 @@
+#include <string.h>
+
+#include "espgotchi_savestate.h"
+#include "espgotchi_sched.h"
+#include "espgotchi_tama_rom.h"
+
+#define SAVESTATE_MAGIC 0x54534745u /* "EGST" */
+
+/* CRC32 par nibble : table de 16 entrées, assez rapide pour < 1 Ko */
+static const u32_t s_crc_nibble[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu,
+    0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+    0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu,
+};
+
+static u32_t s_rom_crc = 0;
+static bool_t s_rom_crc_valid = 0;
+
+u32_t espgotchi_savestate_crc32(u32_t crc, const u8_t *data, u32_t len)
+{
+    u32_t i;
+
+    crc = ~crc;
+    for (i = 0; i < len; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0xF];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0xF];
+    }
+    return ~crc;
+}
+
+u32_t espgotchi_savestate_delta_encode(const u8_t *a, const u8_t *b, u32_t len, u8_t *out)
+{
+    u32_t i = 0;
+    u32_t n = 0;
+    u8_t zeros, lits;
+    u32_t lits_pos;
+
+    while (i < len) {
+        zeros = 0;
+        while (i < len && zeros < 255 && a[i] == b[i]) {
+            zeros++;
+            i++;
+        }
+
+        lits = 0;
+        lits_pos = n + 1;
+        out[n] = zeros;
+        n += 2;
+        while (i < len && lits < 255 && a[i] != b[i]) {
+            out[n++] = a[i] ^ b[i];
+            lits++;
+            i++;
+        }
+        out[lits_pos] = lits;
+    }
+    return n;
+}
+
+void espgotchi_savestate_delta_apply(const u8_t *delta, u32_t delta_len, u8_t *buf, u32_t len)
+{
+    u32_t i = 0;
+    u32_t n = 0;
+    u8_t lits;
+
+    while (n + 2 <= delta_len && i < len) {
+        i += delta[n];
+        lits = delta[n + 1];
+        n += 2;
+        while (lits-- && i < len && n < delta_len) {
+            buf[i++] ^= delta[n++];
+        }
+    }
+}
+
+/* Identité du programme : calculée une fois (la ROM ne change pas) */
+static u32_t rom_crc(void)
+{
+    const u12_t *prog;
+    u32_t count, pc;
+    u8_t word[2];
+
+    if (s_rom_crc_valid) {
+        return s_rom_crc;
+    }
+
+    prog = espgotchi_get_tama_program();
+    count = espgotchi_get_tama_program_word_count();
+    s_rom_crc = 0;
+    for (pc = 0; pc < count; ++pc) {
+        word[0] = (u8_t)(prog[pc] & 0xFF);
+        word[1] = (u8_t)(prog[pc] >> 8);
+        s_rom_crc = espgotchi_savestate_crc32(s_rom_crc, word, 2);
+    }
+    s_rom_crc_valid = 1;
+    return s_rom_crc;
+}
+
+static u8_t *put_u8(u8_t *p, u8_t v)
+{
+    *p++ = v;
+    return p;
+}
+
+static u8_t *put_u16(u8_t *p, uint16_t v)
+{
+    *p++ = (u8_t)v;
+    *p++ = (u8_t)(v >> 8);
+    return p;
+}
+
+static u8_t *put_u32(u8_t *p, u32_t v)
+{
+    *p++ = (u8_t)v;
+    *p++ = (u8_t)(v >> 8);
+    *p++ = (u8_t)(v >> 16);
+    *p++ = (u8_t)(v >> 24);
+    return p;
+}
+
+static uint16_t get_u16(const u8_t **p)
+{
+    const u8_t *q = *p;
+    *p += 2;
+    return (uint16_t)(q[0] | (q[1] << 8));
+}
+
+static u32_t get_u32(const u8_t **p)
+{
+    const u8_t *q = *p;
+    *p += 4;
+    return (u32_t)q[0] | ((u32_t)q[1] << 8) | ((u32_t)q[2] << 16) | ((u32_t)q[3] << 24);
+}
+
+/* Adresse mémoire du n-ième nibble sauvegardé (RAM, afficheur 1 et 2, IO) */
+static u12_t mem_addr(uint16_t n)
+{
+    if (n < MEM_RAM_SIZE) {
+        return MEM_RAM_ADDR + n;
+    }
+    n -= MEM_RAM_SIZE;
+    if (n < MEM_DISPLAY1_SIZE) {
+        return MEM_DISPLAY1_ADDR + n;
+    }
+    n -= MEM_DISPLAY1_SIZE;
+    if (n < MEM_DISPLAY2_SIZE) {
+        return MEM_DISPLAY2_ADDR + n;
+    }
+    return MEM_IO_ADDR + (n - MEM_DISPLAY2_SIZE);
+}
+
+static u4_t mem_get(const MEM_BUFFER_TYPE *mem, uint16_t n)
+{
+    const u12_t addr = mem_addr(n);
+
+    if (n < MEM_RAM_SIZE) {
+        return GET_RAM_MEMORY(mem, addr);
+    } else if (addr < MEM_DISPLAY2_ADDR) {
+        return GET_DISP1_MEMORY(mem, addr);
+    } else if (addr < MEM_IO_ADDR) {
+        return GET_DISP2_MEMORY(mem, addr);
+    }
+    return GET_IO_MEMORY(mem, addr);
+}
+
+static void mem_set(MEM_BUFFER_TYPE *mem, uint16_t n, u4_t v)
+{
+    const u12_t addr = mem_addr(n);
+
+    /* Écriture brute (pas de set_memory() : aucun effet de bord IO) */
+    if (n < MEM_RAM_SIZE) {
+        SET_RAM_MEMORY(mem, addr, v);
+    } else if (addr < MEM_DISPLAY2_ADDR) {
+        SET_DISP1_MEMORY(mem, addr, v);
+    } else if (addr < MEM_IO_ADDR) {
+        SET_DISP2_MEMORY(mem, addr, v);
+    } else {
+        SET_IO_MEMORY(mem, addr, v);
+    }
+}
+
+static u8_t *write_cpu(u8_t *p, const state_t *st)
+{
+    u32_t *const clk_ts[8] = {
+        st->clk_timer_2hz_timestamp,  st->clk_timer_4hz_timestamp,
+        st->clk_timer_8hz_timestamp,  st->clk_timer_16hz_timestamp,
+        st->clk_timer_32hz_timestamp, st->clk_timer_64hz_timestamp,
+        st->clk_timer_128hz_timestamp, st->clk_timer_256hz_timestamp,
+    };
+    uint16_t n;
+    u8_t i;
+
+    p = put_u16(p, *st->pc);
+    p = put_u16(p, *st->x);
+    p = put_u16(p, *st->y);
+    p = put_u8(p, *st->a);
+    p = put_u8(p, *st->b);
+    p = put_u8(p, *st->np);
+    p = put_u8(p, *st->sp);
+    p = put_u8(p, *st->flags);
+
+    p = put_u32(p, *st->tick_counter);
+    for (i = 0; i < 8; ++i) {
+        p = put_u32(p, *clk_ts[i]);
+    }
+    p = put_u32(p, *st->prog_timer_timestamp);
+    p = put_u8(p, *st->prog_timer_enabled);
+    p = put_u8(p, *st->prog_timer_data);
+    p = put_u8(p, *st->prog_timer_rld);
+
+    p = put_u32(p, *st->call_depth);
+    for (i = 0; i < INT_SLOT_NUM; ++i) {
+        p = put_u8(p, st->interrupts[i].factor_flag_reg);
+        p = put_u8(p, st->interrupts[i].mask_reg);
+        p = put_u8(p, st->interrupts[i].triggered);
+    }
+    p = put_u8(p, *st->cpu_halted);
+
+    for (n = 0; n < ESPGOTCHI_SAVESTATE_MEM_NIBBLES; n += 2) {
+        p = put_u8(p, (u8_t)(mem_get(st->memory, n) | (mem_get(st->memory, n + 1) << 4)));
+    }
+    return p;
+}
+
+static void read_cpu(const u8_t *p, state_t *st)
+{
+    u32_t *const clk_ts[8] = {
+        st->clk_timer_2hz_timestamp,  st->clk_timer_4hz_timestamp,
+        st->clk_timer_8hz_timestamp,  st->clk_timer_16hz_timestamp,
+        st->clk_timer_32hz_timestamp, st->clk_timer_64hz_timestamp,
+        st->clk_timer_128hz_timestamp, st->clk_timer_256hz_timestamp,
+    };
+    uint16_t n;
+    u8_t i;
+
+    *st->pc = get_u16(&p) & 0x1FFF;
+    *st->x = get_u16(&p) & 0xFFF;
+    *st->y = get_u16(&p) & 0xFFF;
+    *st->a = *p++ & 0xF;
+    *st->b = *p++ & 0xF;
+    *st->np = *p++ & 0x1F;
+    *st->sp = *p++;
+    *st->flags = *p++ & 0xF;
+
+    *st->tick_counter = get_u32(&p);
+    for (i = 0; i < 8; ++i) {
+        *clk_ts[i] = get_u32(&p);
+    }
+    *st->prog_timer_timestamp = get_u32(&p);
+    *st->prog_timer_enabled = *p++;
+    *st->prog_timer_data = *p++;
+    *st->prog_timer_rld = *p++;
+
+    *st->call_depth = get_u32(&p);
+    for (i = 0; i < INT_SLOT_NUM; ++i) {
+        st->interrupts[i].factor_flag_reg = *p++ & 0xF;
+        st->interrupts[i].mask_reg = *p++ & 0xF;
+        st->interrupts[i].triggered = *p++;
+    }
+    *st->cpu_halted = *p++;
+
+    for (n = 0; n < ESPGOTCHI_SAVESTATE_MEM_NIBBLES; n += 2, ++p) {
+        mem_set(st->memory, n, *p & 0xF);
+        mem_set(st->memory, n + 1, *p >> 4);
+    }
+}
+
+u32_t espgotchi_savestate_write(u8_t *buf, u32_t cap, const u8_t *host, u32_t host_len)
+{
+    const u32_t payload = ESPGOTCHI_SAVESTATE_CPU_SIZE + host_len;
+    u8_t *const body = buf + ESPGOTCHI_SAVESTATE_HEADER_SIZE;
+    u8_t *p;
+
+    if (host_len > ESPGOTCHI_SAVESTATE_HOST_MAX || cap < ESPGOTCHI_SAVESTATE_HEADER_SIZE + payload) {
+        return 0;
+    }
+
+    p = write_cpu(body, cpu_get_state());
+    if (host_len > 0) {
+        memcpy(p, host, host_len);
+    }
+
+    p = put_u32(buf, SAVESTATE_MAGIC);
+    p = put_u16(p, ESPGOTCHI_SAVESTATE_VERSION);
+    p = put_u16(p, ESPGOTCHI_SAVESTATE_CPU_SIZE);
+    p = put_u16(p, (uint16_t)host_len);
+    p = put_u16(p, 0); /* réservé */
+    p = put_u32(p, rom_crc());
+    put_u32(p, espgotchi_savestate_crc32(0, body, payload));
+
+    return ESPGOTCHI_SAVESTATE_HEADER_SIZE + payload;
+}
+
+bool_t espgotchi_savestate_read(const u8_t *buf, u32_t len, const u8_t **host, u32_t *host_len)
+{
+    const u8_t *p = buf;
+    uint16_t version, cpu_size, host_size;
+    u32_t rom, crc;
+
+    if (buf == NULL || len < ESPGOTCHI_SAVESTATE_HEADER_SIZE || get_u32(&p) != SAVESTATE_MAGIC) {
+        return 0;
+    }
+
+    version = get_u16(&p);
+    cpu_size = get_u16(&p);
+    host_size = get_u16(&p);
+    p += 2;
+    rom = get_u32(&p);
+    crc = get_u32(&p);
+
+    if (version != ESPGOTCHI_SAVESTATE_VERSION || cpu_size != ESPGOTCHI_SAVESTATE_CPU_SIZE ||
+        host_size > ESPGOTCHI_SAVESTATE_HOST_MAX ||
+        len < (u32_t)ESPGOTCHI_SAVESTATE_HEADER_SIZE + cpu_size + host_size) {
+        return 0;
+    }
+    if (rom != rom_crc() || crc != espgotchi_savestate_crc32(0, p, cpu_size + host_size)) {
+        return 0;
+    }
+
+    read_cpu(p, cpu_get_state());
+
+    /* previous_cycles de cpu_step() n'est pas dans state_t : l'ordonnanceur
+     * repart de son majorant, et l'afficheur / buzzer suivent la mémoire */
+    espgotchi_sched_reset();
+    cpu_refresh_hw();
+
+    if (host != NULL) {
+        *host = p + cpu_size;
+    }
+    if (host_len != NULL) {
+        *host_len = host_size;
+    }
+    return 1;
+}
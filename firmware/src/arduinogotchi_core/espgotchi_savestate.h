@@ -0,0 +1,62 @@
+#ifndef _ESPGOTCHI_SAVESTATE_H_
+#define _ESPGOTCHI_SAVESTATE_H_
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Save-state Espgotchi
+ * --------------------
+ * Instantané binaire de tout l'état émulé exposé par cpu_get_state() :
+ * registres, flags, PC, timers, interruptions et mémoire (RAM, afficheur,
+ * IO, deux nibbles par octet). L'hôte peut y joindre une section opaque
+ * (ex. matrice LCD et icônes de VideoService).
+ *
+ * Format (petit-boutiste, indépendant de l'architecture) :
+ *   en-tête  "EGST", version, taille CPU, taille hôte, CRC ROM, CRC32
+ *   section CPU  ESPGOTCHI_SAVESTATE_CPU_SIZE octets
+ *   section hôte 0..ESPGOTCHI_SAVESTATE_HOST_MAX octets
+ * Le CRC32 couvre tout ce qui suit l'en-tête ; le CRC ROM refuse un
+ * instantané pris avec un autre programme.
+ */
+
+#define ESPGOTCHI_SAVESTATE_VERSION     1
+
+#define ESPGOTCHI_SAVESTATE_HEADER_SIZE 20
+#define ESPGOTCHI_SAVESTATE_MEM_NIBBLES (MEM_RAM_SIZE + MEM_DISPLAY1_SIZE + MEM_DISPLAY2_SIZE + MEM_IO_SIZE)
+#define ESPGOTCHI_SAVESTATE_CPU_SIZE    (77 + ESPGOTCHI_SAVESTATE_MEM_NIBBLES / 2)
+#define ESPGOTCHI_SAVESTATE_HOST_MAX    128
+#define ESPGOTCHI_SAVESTATE_MAX_SIZE    (ESPGOTCHI_SAVESTATE_HEADER_SIZE + ESPGOTCHI_SAVESTATE_CPU_SIZE + ESPGOTCHI_SAVESTATE_HOST_MAX)
+
+/* Sérialise l'état courant (+ section hôte, host_len <= HOST_MAX) dans buf.
+ * Retourne la taille écrite, 0 si cap est trop petit.
+ */
+u32_t espgotchi_savestate_write(u8_t *buf, u32_t cap, const u8_t *host, u32_t host_len);
+
+/* Vérifie un instantané (magic, version, tailles, CRC, ROM) puis restaure
+ * l'état CPU et ré-émet afficheur et buzzer vers le HAL (cpu_refresh_hw()).
+ * Rien n'est modifié si l'instantané est invalide (retour 0).
+ * *host / *host_len (optionnels) désignent la section hôte dans buf.
+ */
+bool_t espgotchi_savestate_read(const u8_t *buf, u32_t len, const u8_t **host, u32_t *host_len);
+
+/* Delta entre deux instantanés de même taille : XOR octet à octet compressé
+ * en RLE ([zéros u8][littéraux u8][littéraux...]). Symétrique : appliqué à
+ * l'un des deux, il redonne l'autre. out : ESPGOTCHI_SAVESTATE_DELTA_MAX(len)
+ * octets au pire. Retourne la taille du delta.
+ */
+#define ESPGOTCHI_SAVESTATE_DELTA_MAX(len) ((len) * 3 / 2 + 4)
+u32_t espgotchi_savestate_delta_encode(const u8_t *a, const u8_t *b, u32_t len, u8_t *out);
+void espgotchi_savestate_delta_apply(const u8_t *delta, u32_t delta_len, u8_t *buf, u32_t len);
+
+/* CRC32 (IEEE 802.3) incrémental : crc = 0 au départ */
+u32_t espgotchi_savestate_crc32(u32_t crc, const u8_t *data, u32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_SAVESTATE_H_ */
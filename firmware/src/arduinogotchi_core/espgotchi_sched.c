@@ -0,0 +1,216 @@
+#include "tamalib.h"
+
+#include "espgotchi_sched.h"
+#include "espgotchi_block_cache.h"
+#include "espgotchi_decode.h"
+#include "espgotchi_tama_rom.h"
+#include "espgotchi_profile.h"
+#include "espgotchi_trace.h"
+
+/*
+ * Échéances : cpu_step() ajoute la durée d'une instruction au début de
+ * l'instruction suivante (previous_cycles), puis appelle handle_timers() et
+ * process_interrupts(). Une échéance D est donc servie juste après la
+ * première instruction qui démarre à D ou plus tard (en temps réel CPU).
+ *
+ * Les moteurs ajoutent leurs ticks tout de suite ; au début d'un lot, le
+ * temps réel vaut tick_counter + previous_cycles du dernier cpu_step(), que
+ * TamaLIB ne rajoutera qu'au pas suivant. En retenant cette durée ici (elle
+ * se lit dans le programme pré-décodé), le budget d'un lot s'arrête
+ * exactement avant l'instruction de l'échéance, au lieu d'une marge fixe de
+ * la durée maximale d'une instruction.
+ */
+
+#define TIMER_CLK_COUNT     8
+#define TIMER_PROG_PERIOD   128
+#define FLAG_I              (0x1 << 3)
+
+/* Durée maximale d'une instruction (RETS/RETD) : majorant sûr de
+ * previous_cycles quand on ne le connaît pas (démarrage, CPU arrêté).
+ */
+#define SCHED_MAX_CYCLES    12
+
+static u8_t s_owed_cycles = SCHED_MAX_CYCLES;
+static bool_t s_owed_exact = 0;
+
+/* CPU arrêté (HALT/SLP) : un pas cpu_step() ne fait que facturer
+ * previous_cycles et servir timers/interruptions. Quand deux pas d'arrêt
+ * successifs ont facturé la même durée, le suivant la facturera aussi :
+ * s_halt_cycles la retient (0 = régime d'arrêt pas encore établi).
+ */
+static u8_t s_halt_delta = 0;
+static u8_t s_halt_cycles = 0;
+
+u32_t espgotchi_sched_ticks_to_next_timer(void)
+{
+    state_t *st = cpu_get_state();
+    const u32_t now = *st->tick_counter;
+    u32_t *const clk_ts[TIMER_CLK_COUNT] = {
+        st->clk_timer_2hz_timestamp,  st->clk_timer_4hz_timestamp,
+        st->clk_timer_8hz_timestamp,  st->clk_timer_16hz_timestamp,
+        st->clk_timer_32hz_timestamp, st->clk_timer_64hz_timestamp,
+        st->clk_timer_128hz_timestamp, st->clk_timer_256hz_timestamp,
+    };
+    u32_t best = 0xFFFFFFFFu;
+    u32_t elapsed;
+    u8_t i;
+
+    for (i = 0; i < TIMER_CLK_COUNT; ++i) {
+        const u32_t period = 16384u >> i; /* 2 Hz .. 256 Hz */
+        elapsed = now - *clk_ts[i];
+        if (elapsed >= period) {
+            return 0;
+        }
+        if (period - elapsed < best) {
+            best = period - elapsed;
+        }
+    }
+
+    if (*st->prog_timer_enabled) {
+        elapsed = now - *st->prog_timer_timestamp;
+        if (elapsed >= TIMER_PROG_PERIOD) {
+            return 0;
+        }
+        if (TIMER_PROG_PERIOD - elapsed < best) {
+            best = TIMER_PROG_PERIOD - elapsed;
+        }
+    }
+
+    return best;
+}
+
+u32_t espgotchi_sched_budget(void)
+{
+    const u32_t remaining = espgotchi_sched_ticks_to_next_timer();
+
+    return (remaining > s_owed_cycles) ? remaining - s_owed_cycles : 0;
+}
+
+void espgotchi_sched_step(void)
+{
+    state_t *st = cpu_get_state();
+    const espgotchi_decoded_op_t *const prog = espgotchi_get_tama_decoded_program();
+    const u13_t pc = *st->pc;
+    const bool_t halted = *st->cpu_halted;
+    const u32_t ticks = *st->tick_counter;
+
+    tamalib_step();
+
+    if (*st->tick_counter == ticks && *st->pc == pc && *st->cpu_halted == halted) {
+        /* TamaLIB en pause : aucun pas exécuté */
+        return;
+    }
+
+    if (halted) {
+        /* Pas d'arrêt : cpu_step() a facturé previous_cycles et le remplace
+         * par la durée d'arrêt, que l'on connaît une fois le régime établi */
+        const u32_t delta = *st->tick_counter - ticks;
+        if (*st->cpu_halted) {
+            s_halt_cycles = (delta == s_halt_delta) ? s_halt_delta : 0;
+            s_halt_delta = (delta <= SCHED_MAX_CYCLES) ? (u8_t)delta : 0;
+        }
+        s_owed_cycles = s_halt_cycles ? s_halt_cycles : SCHED_MAX_CYCLES;
+        s_owed_exact = (s_halt_cycles != 0);
+        if (!*st->cpu_halted) {
+            s_halt_delta = 0;
+            s_halt_cycles = 0;
+        }
+    } else {
+        ESPGOTCHI_PROFILE_PC(pc);
+        ESPGOTCHI_TRACE_OP(pc, ESPGOTCHI_TRACE_STEP, *st->a, *st->b, *st->sp, *st->x, *st->y, *st->flags);
+        s_halt_delta = 0;
+        s_halt_cycles = 0;
+        if (prog == NULL || pc >= espgotchi_get_tama_program_word_count() ||
+            prog[pc].kind == ESPGOTCHI_OP_UNKNOWN) {
+            s_owed_cycles = SCHED_MAX_CYCLES;
+            s_owed_exact = 0;
+        } else {
+            s_owed_cycles = prog[pc].cycles;
+            s_owed_exact = 1;
+        }
+    }
+}
+
+u32_t espgotchi_sched_skip_halt(u32_t max_steps, u32_t *idle_ticks)
+{
+    state_t *st = cpu_get_state();
+    bool_t int_pending = 0;
+    u32_t remaining, n;
+    u8_t i;
+
+    *idle_ticks = 0;
+
+    if (!*st->cpu_halted || s_halt_cycles == 0) {
+        return 0;
+    }
+
+    /* Une interruption à servir réveillera le CPU dès le prochain pas */
+    for (i = 0; i < INT_SLOT_NUM; ++i) {
+        int_pending |= st->interrupts[i].triggered;
+    }
+    if ((*st->flags & FLAG_I) && int_pending) {
+        return 0;
+    }
+
+    /* Pas d'arrêt qui n'atteignent pas l'échéance : rien ne peut s'y passer */
+    remaining = espgotchi_sched_ticks_to_next_timer();
+    n = (remaining > 0) ? (remaining - 1) / s_halt_cycles : 0;
+    if (n > max_steps) {
+        n = max_steps;
+    }
+
+    *idle_ticks = n * s_halt_cycles;
+    *st->tick_counter += *idle_ticks;
+    return n;
+}
+
+u8_t espgotchi_sched_owed_cycles(bool_t *exact)
+{
+    if (exact != NULL) {
+        *exact = s_owed_exact;
+    }
+    return s_owed_cycles;
+}
+
+void espgotchi_sched_reset(void)
+{
+    s_owed_cycles = SCHED_MAX_CYCLES;
+    s_owed_exact = 0;
+    s_halt_delta = 0;
+    s_halt_cycles = 0;
+}
+
+u32_t espgotchi_sched_run(espgotchi_engine_t engine, u32_t max_instr, u32_t *idle_ticks)
+{
+    u32_t done = 0;
+    u32_t n, ticks;
+
+    *idle_ticks = 0;
+
+    while (done < max_instr) {
+        n = 0;
+        if (engine == ESPGOTCHI_ENGINE_BLOCK) {
+            n = espgotchi_block_run(max_instr - done, &ticks);
+        } else if (engine == ESPGOTCHI_ENGINE_DECODED) {
+            n = espgotchi_cpu_fast_run(max_instr - done, &ticks);
+        }
+        ESPGOTCHI_PROFILE_PATH(ESPGOTCHI_PROFILE_ENGINE, n);
+
+        /* CPU arrêté : saut direct jusqu'à la prochaine échéance */
+        if (n == 0 && engine != ESPGOTCHI_ENGINE_TAMALIB) {
+            n = espgotchi_sched_skip_halt(max_instr - done, &ticks);
+            *idle_ticks += ticks;
+            ESPGOTCHI_PROFILE_PATH(ESPGOTCHI_PROFILE_HALT, n);
+        }
+
+        /* Échéance atteinte, IO, HALT ou interruption : un pas TamaLIB */
+        if (n == 0) {
+            espgotchi_sched_step();
+            ESPGOTCHI_PROFILE_PATH(ESPGOTCHI_PROFILE_STEP, 1);
+            n = 1;
+        }
+        done += n;
+    }
+
+    return done;
+}
@@ -0,0 +1,67 @@
+#ifndef _ESPGOTCHI_SCHED_H_
+#define _ESPGOTCHI_SCHED_H_
+
+#include "cpu.h"
+#include "espgotchi_cpu_fast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Ordonnanceur à évènements des moteurs Espgotchi
+ * -----------------------------------------------
+ * Au lieu de laisser cpu_step() scruter timers et interruptions après chaque
+ * instruction, on calcule la prochaine échéance (horloge 2..256 Hz, timer
+ * programmable), on exécute d'un trait toutes les instructions qui la
+ * précèdent dans un moteur Espgotchi, puis un seul cpu_step() exécute
+ * l'instruction de l'échéance et sert timers et interruptions.
+ */
+
+/* Nombre de ticks 32 kHz avant la prochaine échéance d'un timer TamaLIB
+ * (horloge 2..256 Hz ou timer programmable s'il est actif).
+ */
+u32_t espgotchi_sched_ticks_to_next_timer(void);
+
+/* Ticks qu'un moteur peut consommer avant de rendre la main : une instruction
+ * peut démarrer tant que les ticks déjà consommés restent en dessous.
+ * 0 : la prochaine instruction doit passer par espgotchi_sched_step().
+ */
+u32_t espgotchi_sched_budget(void);
+
+/* tamalib_step(), en retenant la durée que cpu_step() facturera au pas
+ * suivant (previous_cycles), pour que le budget tombe pile sur l'échéance.
+ */
+void espgotchi_sched_step(void);
+
+/* Durée retenue : ce que le prochain cpu_step() facturera avant d'exécuter.
+ * *exact (si non NULL) vaut 0 quand ce n'est qu'un majorant (démarrage,
+ * chargement d'état, régime d'arrêt pas encore établi). Exacte, tick_counter
+ * plus cette durée donne le temps émulé quel que soit le moteur (lockstep).
+ */
+u8_t espgotchi_sched_owed_cycles(bool_t *exact);
+
+/* Oublie la durée retenue (après tamalib_init() ou un reset CPU) */
+void espgotchi_sched_reset(void);
+
+/* CPU arrêté (HALT/SLP) en régime établi : avance tick_counter d'un coup
+ * sur les pas d'arrêt (au plus max_steps) qui précèdent la prochaine
+ * échéance, exactement comme autant de cpu_step() sans effet.
+ * Retourne le nombre de pas sautés (0 : faire un vrai pas) ; *idle_ticks
+ * reçoit les ticks correspondants.
+ */
+u32_t espgotchi_sched_skip_halt(u32_t max_steps, u32_t *idle_ticks);
+
+/* Exécute max_instr instructions (pas TamaLIB et pas d'arrêt sautés compris)
+ * avec le moteur donné : lots jusqu'à chaque échéance, puis un pas TamaLIB
+ * pour la servir. ESPGOTCHI_ENGINE_TAMALIB : pas TamaLIB uniquement (ni saut
+ * d'arrêt, TamaLIB cadence alors lui-même). *idle_ticks reçoit les ticks
+ * passés CPU arrêté et sautés. Retourne max_instr.
+ */
+u32_t espgotchi_sched_run(espgotchi_engine_t engine, u32_t max_instr, u32_t *idle_ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_SCHED_H_ */
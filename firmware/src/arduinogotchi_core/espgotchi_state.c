@@ -158,6 +158,47 @@ void espgotchi_read_logical_state(espgotchi_logical_state_t *out)
     // debug_dump_ram_diff();
 }
 
+bool_t espgotchi_read_clock(u32_t *seconds_of_day)
+{
+    const u8_t sec_u = p1_ram_read(P1_RAM_ADDR_CLOCK_SEC_U);
+    const u8_t sec_t = p1_ram_read(P1_RAM_ADDR_CLOCK_SEC_T);
+    const u8_t min_u = p1_ram_read(P1_RAM_ADDR_CLOCK_MIN_U);
+    const u8_t min_t = p1_ram_read(P1_RAM_ADDR_CLOCK_MIN_T);
+    const u8_t hour = p1_hour_to_uint(p1_ram_read(P1_RAM_ADDR_CLOCK_HOUR_T), p1_ram_read(P1_RAM_ADDR_CLOCK_HOUR_U));
+
+    if (sec_u > 9 || sec_t > 5 || min_u > 9 || min_t > 5 || hour > 23)
+    {
+        return 0;
+    }
+
+    *seconds_of_day = hour * 3600u + p1_bcd_to_uint(min_t, min_u) * 60u + p1_bcd_to_uint(sec_t, sec_u);
+    return 1;
+}
+
+bool_t espgotchi_advance_clock(u32_t seconds)
+{
+    state_t *st = cpu_get_state();
+    u32_t now;
+
+    if (st == NULL || st->memory == NULL || !espgotchi_read_clock(&now))
+    {
+        return 0;
+    }
+
+    now = (now + seconds % 86400u) % 86400u;
+    const u8_t hour = (u8_t)(now / 3600u);
+    const u8_t minute = (u8_t)(now / 60u % 60u);
+    const u8_t second = (u8_t)(now % 60u);
+
+    SET_RAM_MEMORY(st->memory, MEM_RAM_ADDR + P1_RAM_ADDR_CLOCK_SEC_U, second % 10u);
+    SET_RAM_MEMORY(st->memory, MEM_RAM_ADDR + P1_RAM_ADDR_CLOCK_SEC_T, second / 10u);
+    SET_RAM_MEMORY(st->memory, MEM_RAM_ADDR + P1_RAM_ADDR_CLOCK_MIN_U, minute % 10u);
+    SET_RAM_MEMORY(st->memory, MEM_RAM_ADDR + P1_RAM_ADDR_CLOCK_MIN_T, minute / 10u);
+    SET_RAM_MEMORY(st->memory, MEM_RAM_ADDR + P1_RAM_ADDR_CLOCK_HOUR_U, hour & 0x0F);
+    SET_RAM_MEMORY(st->memory, MEM_RAM_ADDR + P1_RAM_ADDR_CLOCK_HOUR_T, hour >> 4);
+    return 1;
+}
+
 void espgotchi_debug_dump_state(const espgotchi_logical_state_t *st)
 {
     if (st == NULL)
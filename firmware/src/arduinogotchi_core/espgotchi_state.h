@@ -32,6 +32,17 @@ typedef struct {
 /* Populate the structure by reading the emulated Vpet RAM */
 void espgotchi_read_logical_state(espgotchi_logical_state_t *out);
 
+/* Internal Vpet clock as seconds since midnight (0..86399), read from the P1
+ * clock RAM without logging. Returns 0 if the RAM does not hold a valid time.
+ */
+bool_t espgotchi_read_clock(u32_t *seconds_of_day);
+
+/* Moves the internal Vpet clock forward by `seconds` (wrapping at 24h) by
+ * rewriting the P1 clock RAM; the sub-second prescaler is left untouched.
+ * Returns 0 (nothing written) if the RAM does not hold a valid time.
+ */
+bool_t espgotchi_advance_clock(u32_t seconds);
+
 /* Debug helper that logs the current logical state */
 void espgotchi_debug_dump_state(const espgotchi_logical_state_t *st);
 
@@ -16,9 +16,16 @@
 
 /* Programme TamaLIB au format attendu par cpu.c (un u12_t par opcode) */
 static u12_t s_program[ESPGOTCHI_PROGRAM_WORDS];
+
+/* Même programme pré-décodé : évite la recherche dans la table d'opcodes
+ * à chaque instruction exécutée (4 octets/opcode, en DRAM).
+ */
+static espgotchi_decoded_op_t s_decoded[ESPGOTCHI_PROGRAM_WORDS];
 static bool_t s_program_initialized = 0;
 
-/* Dépacke g_program_b12 (3 octets -> 2 opcodes 12 bits) dans s_program[] */
+/* Dépacke g_program_b12 (3 octets -> 2 opcodes 12 bits) dans s_program[],
+ * puis pré-décode chaque opcode dans s_decoded[].
+ */
 static void espgotchi_build_program(void)
 {
     if (s_program_initialized) {
@@ -46,6 +53,11 @@ static void espgotchi_build_program(void)
         }
     }
 
+    /* Seconde passe : décodage une fois pour toutes */
+    for (u32_t pc = 0; pc < op_count; ++pc) {
+        espgotchi_decode_op(s_program[pc], &s_decoded[pc]);
+    }
+
     s_program_initialized = 1;
 }
 
@@ -56,6 +68,18 @@ const u12_t *espgotchi_get_tama_program(void)
     return s_program;
 }
 
+const espgotchi_decoded_op_t *espgotchi_get_tama_decoded_program(void)
+{
+    espgotchi_build_program();
+    return s_decoded;
+}
+
+void espgotchi_rebuild_tama_program(void)
+{
+    s_program_initialized = 0;
+    espgotchi_build_program();
+}
+
 u32_t espgotchi_get_tama_program_word_count(void)
 {
     return ESPGOTCHI_PROGRAM_WORDS;
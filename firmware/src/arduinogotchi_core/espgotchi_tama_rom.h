@@ -2,6 +2,7 @@
 #define _ESPGOTCHI_TAMA_ROM_H_
 
 #include "cpu.h"   // pour u12_t et breakpoint_t
+#include "espgotchi_decode.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +14,16 @@ extern "C" {
 const u12_t *espgotchi_get_tama_program(void);
 u32_t espgotchi_get_tama_program_word_count(void);
 
+/* Même programme, pré-décodé au dépackage (un espgotchi_decoded_op_t par
+ * opcode, même indexation que espgotchi_get_tama_program()).
+ */
+const espgotchi_decoded_op_t *espgotchi_get_tama_decoded_program(void);
+
+/* Refait le dépackage + décodage (contenu identique : le cache de blocs
+ * reste valable). Sert au banc de mesure (src/bench).
+ */
+void espgotchi_rebuild_tama_program(void);
+
 /* Retourne la liste de breakpoints (ou NULL).
  * Pour l’instant, on n’utilise pas de breakpoints côté Espgotchi.
  */
@@ -3,6 +3,8 @@
 #include "esp_rom_sys.h"
 
 #include "espgotchi_tamalib_ext.h"
+#include "espgotchi_block_cache.h"
+#include "espgotchi_sched.h"
 
 static bool_t espgotchi_validate_breakpoints(const breakpoint_t *breakpoints)
 {
@@ -40,6 +42,10 @@ bool_t tamalib_init_espgotchi(u32_t freq)
         return 0;
     }
 
+    /* Nouveau programme : les blocs traduits précédemment ne valent plus rien */
+    espgotchi_block_cache_flush();
+    espgotchi_sched_reset();
+
     return tamalib_init(program, breakpoints, freq);
 }
 /* ---- API TamaLIB "officielle" restaurée ---- */
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "espgotchi_trace.h"
+#include "espgotchi_tama_rom.h"
+
+#if ESPGOTCHI_TRACE
+
+espgotchi_trace_rec_t *espgotchi_trace_buf = NULL;
+u32_t espgotchi_trace_mask = 0;
+u32_t espgotchi_trace_pos = 0;
+
+static espgotchi_trace_rec_t *s_ring = NULL;
+
+bool_t espgotchi_trace_begin(u32_t entries)
+{
+    u32_t size = 1;
+
+    if (s_ring == NULL) {
+        while (size * 2 <= entries) {
+            size *= 2;
+        }
+        s_ring = (espgotchi_trace_rec_t *)g_hal->malloc(sizeof(espgotchi_trace_rec_t) * size);
+        if (s_ring == NULL) {
+            g_hal->log(LOG_ERROR, "[Trace] allocation failed, trace disabled\n");
+            return 0;
+        }
+        espgotchi_trace_mask = size - 1;
+    }
+
+    espgotchi_trace_pos = 0;
+    espgotchi_trace_buf = s_ring;
+    return 1;
+}
+
+void espgotchi_trace_stop(void)
+{
+    espgotchi_trace_buf = NULL;
+}
+
+void espgotchi_trace_start(void)
+{
+    espgotchi_trace_buf = s_ring;
+}
+
+bool_t espgotchi_trace_recording(void)
+{
+    return espgotchi_trace_buf != NULL;
+}
+
+u32_t espgotchi_trace_count(void)
+{
+    if (s_ring == NULL) {
+        return 0;
+    }
+    return (espgotchi_trace_pos > espgotchi_trace_mask) ? espgotchi_trace_mask + 1 : espgotchi_trace_pos;
+}
+
+const espgotchi_trace_rec_t *espgotchi_trace_get(u32_t i)
+{
+    const u32_t n = espgotchi_trace_count();
+
+    if (i >= n) {
+        return NULL;
+    }
+    return &s_ring[(espgotchi_trace_pos - n + i) & espgotchi_trace_mask];
+}
+
+#else
+
+bool_t espgotchi_trace_begin(u32_t entries)
+{
+    (void)entries;
+    return 0;
+}
+
+void espgotchi_trace_stop(void)
+{
+}
+
+void espgotchi_trace_start(void)
+{
+}
+
+bool_t espgotchi_trace_recording(void)
+{
+    return 0;
+}
+
+u32_t espgotchi_trace_count(void)
+{
+    return 0;
+}
+
+const espgotchi_trace_rec_t *espgotchi_trace_get(u32_t i)
+{
+    (void)i;
+    return NULL;
+}
+
+#endif
+
+/* Le décodeur sert aussi sans enregistreur (natif : traces venues de l'ESP32) */
+u32_t espgotchi_trace_format(const espgotchi_trace_rec_t *rec, const espgotchi_trace_rec_t *prev, char *buf,
+                             u32_t cap)
+{
+    static const char *const s_paths[4] = {"dec", "blk", "stp", "???"};
+    const u12_t *const rom = espgotchi_get_tama_program();
+    const u32_t words = espgotchi_get_tama_program_word_count();
+    const u13_t pc = ESPGOTCHI_TRACE_PC(rec);
+    u32_t n = 0;
+    u8_t k;
+    int w;
+
+    if (cap == 0) {
+        return 0;
+    }
+
+    /* Une ou deux instructions (super-instruction du moteur à blocs) */
+    for (k = 0; k <= ESPGOTCHI_TRACE_IS_PAIR(rec); ++k) {
+        const u13_t at = (pc + k) & 0x1FFF;
+        espgotchi_decoded_op_t d;
+
+        if (rom != NULL && at < words) {
+            espgotchi_decode_op(rom[at], &d);
+            w = snprintf(buf + n, cap - n, "%s%04X  %03X  %-9s %02X %02X", k ? " ; " : "", at, rom[at],
+                         espgotchi_op_name(d.kind), d.arg0, d.arg1);
+        } else {
+            w = snprintf(buf + n, cap - n, "%s%04X  ???", k ? " ; " : "", at);
+        }
+        n = (w > 0 && n + (u32_t)w < cap) ? n + (u32_t)w : cap - 1;
+    }
+
+    w = snprintf(buf + n, cap - n, "  [%s]", s_paths[ESPGOTCHI_TRACE_PATH(rec)]);
+    n = (w > 0 && n + (u32_t)w < cap) ? n + (u32_t)w : cap - 1;
+
+#define TRACE_REG(name, get, fmt) \
+    if (prev == NULL || get(prev) != get(rec)) { \
+        w = snprintf(buf + n, cap - n, " " name "=" fmt, get(rec)); \
+        n = (w > 0 && n + (u32_t)w < cap) ? n + (u32_t)w : cap - 1; \
+    }
+
+    TRACE_REG("A", ESPGOTCHI_TRACE_A, "%X")
+    TRACE_REG("B", ESPGOTCHI_TRACE_B, "%X")
+    TRACE_REG("X", ESPGOTCHI_TRACE_X, "%03X")
+    TRACE_REG("Y", ESPGOTCHI_TRACE_Y, "%03X")
+    TRACE_REG("SP", ESPGOTCHI_TRACE_SP, "%02X")
+
+#undef TRACE_REG
+
+    if (prev == NULL || ESPGOTCHI_TRACE_FLAGS(prev) != ESPGOTCHI_TRACE_FLAGS(rec)) {
+        const u4_t f = ESPGOTCHI_TRACE_FLAGS(rec);
+        w = snprintf(buf + n, cap - n, " F=%c%c%c%c", (f & 0x8) ? 'I' : '-', (f & 0x4) ? 'D' : '-',
+                     (f & 0x2) ? 'Z' : '-', (f & 0x1) ? 'C' : '-');
+        n = (w > 0 && n + (u32_t)w < cap) ? n + (u32_t)w : cap - 1;
+    }
+
+    return n;
+}
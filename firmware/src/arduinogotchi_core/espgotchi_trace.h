@@ -0,0 +1,99 @@
+#ifndef _ESPGOTCHI_TRACE_H_
+#define _ESPGOTCHI_TRACE_H_
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Trace d'exécution (optionnelle)
+ * -------------------------------
+ * Chaque instruction exécutée (moteurs décodé et blocs, pas TamaLIB) ajoute
+ * un enregistrement de 8 octets dans un anneau : PC, chemin, et registres
+ * après l'instruction. L'opcode se relit dans la ROM à partir du PC ; les
+ * deltas de registres se calculent au décodage, entre deux enregistrements.
+ * Un enregistrement = deux écritures 32 bits : le coût reste de quelques
+ * cycles par instruction et la cadence émulée n'en dépend pas.
+ *
+ * Compilée seulement avec -D ESPGOTCHI_TRACE=1 (vide sinon).
+ * Anneau de ESPGOTCHI_TRACE_ENTRIES enregistrements (puissance de 2),
+ * alloué par g_hal->malloc (PSRAM si disponible).
+ */
+#ifndef ESPGOTCHI_TRACE
+#define ESPGOTCHI_TRACE 0
+#endif
+
+#ifndef ESPGOTCHI_TRACE_ENTRIES
+#define ESPGOTCHI_TRACE_ENTRIES 4096
+#endif
+
+/* Chemin d'exécution (bits 13..14 de w0) + paire fusionnée (bit 15) */
+#define ESPGOTCHI_TRACE_DECODED 0
+#define ESPGOTCHI_TRACE_BLOCK   1
+#define ESPGOTCHI_TRACE_STEP    2
+#define ESPGOTCHI_TRACE_PAIR    4 /* super-instruction : PC et PC+1, registres après les deux */
+
+/* w0 : PC (13) | chemin (3) << 13 | A << 16 | B << 20 | SP << 24
+ * w1 : X (12) | Y (12) << 12 | flags (4) << 24
+ */
+typedef struct {
+    u32_t w0;
+    u32_t w1;
+} espgotchi_trace_rec_t;
+
+#define ESPGOTCHI_TRACE_PC(r)    ((u13_t)((r)->w0 & 0x1FFF))
+#define ESPGOTCHI_TRACE_PATH(r)  ((u8_t)(((r)->w0 >> 13) & 0x3))
+#define ESPGOTCHI_TRACE_IS_PAIR(r) (((r)->w0 >> 15) & 0x1)
+#define ESPGOTCHI_TRACE_A(r)     ((u4_t)(((r)->w0 >> 16) & 0xF))
+#define ESPGOTCHI_TRACE_B(r)     ((u4_t)(((r)->w0 >> 20) & 0xF))
+#define ESPGOTCHI_TRACE_SP(r)    ((u8_t)((r)->w0 >> 24))
+#define ESPGOTCHI_TRACE_X(r)     ((u12_t)((r)->w1 & 0xFFF))
+#define ESPGOTCHI_TRACE_Y(r)     ((u12_t)(((r)->w1 >> 12) & 0xFFF))
+#define ESPGOTCHI_TRACE_FLAGS(r) ((u4_t)(((r)->w1 >> 24) & 0xF))
+
+#if ESPGOTCHI_TRACE
+extern espgotchi_trace_rec_t *espgotchi_trace_buf; /* NULL : enregistrement arrêté */
+extern u32_t espgotchi_trace_mask;
+extern u32_t espgotchi_trace_pos;
+
+#define ESPGOTCHI_TRACE_OP(pc, path, a, b, sp, x, y, flags) \
+    do { \
+        if (espgotchi_trace_buf != NULL) { \
+            espgotchi_trace_rec_t *r_ = &espgotchi_trace_buf[espgotchi_trace_pos++ & espgotchi_trace_mask]; \
+            r_->w0 = (u32_t)(pc) | ((u32_t)(path) << 13) | ((u32_t)(a) << 16) | \
+                     ((u32_t)(b) << 20) | ((u32_t)(sp) << 24); \
+            r_->w1 = (u32_t)(x) | ((u32_t)(y) << 12) | ((u32_t)(flags) << 24); \
+        } \
+    } while (0)
+#else
+#define ESPGOTCHI_TRACE_OP(pc, path, a, b, sp, x, y, flags) ((void)0)
+#endif
+
+/* Alloue l'anneau (une fois, entries arrondi à une puissance de 2), le vide
+ * et démarre l'enregistrement. 0 si indisponible.
+ */
+bool_t espgotchi_trace_begin(u32_t entries);
+
+/* Fige / reprend l'enregistrement (l'anneau est conservé) */
+void espgotchi_trace_stop(void);
+void espgotchi_trace_start(void);
+bool_t espgotchi_trace_recording(void);
+
+/* Enregistrements disponibles ; i = 0 : le plus ancien */
+u32_t espgotchi_trace_count(void);
+const espgotchi_trace_rec_t *espgotchi_trace_get(u32_t i);
+
+/* Ligne de désassemblage : PC, opcode ROM, mnémonique + arguments, chemin,
+ * puis registres modifiés depuis prev (tous si prev est NULL).
+ * Retourne la longueur écrite dans buf.
+ */
+u32_t espgotchi_trace_format(const espgotchi_trace_rec_t *rec, const espgotchi_trace_rec_t *prev, char *buf,
+                             u32_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESPGOTCHI_TRACE_H_ */
@@ -0,0 +1,326 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <math.h>
+
+extern "C"
+{
+#include "tamalib.h"
+#include "cpu.h"
+#include "../arduinogotchi_core/espgotchi_sched.h"
+#include "../arduinogotchi_core/espgotchi_tama_rom.h"
+}
+
+#include "../VideoService.h"
+#include "../InputService.h"
+#include "../AudioService.h"
+#include "../TamaHost.h"
+#include "../EspgotchiInput.h"
+
+#ifdef ESPGOTCHI_NATIVE
+#include <XPT2046_Touchscreen.h>
+#endif
+
+// Banc de mesure des chemins chauds ([env:esp32-cyd-bench], [env:native-bench]).
+// Chaque mesure : ESPGOTCHI_BENCH_WARMUP passes de chauffe puis
+// ESPGOTCHI_BENCH_SAMPLES échantillons de `ops` opérations, temps en ns/op.
+// Sortie lisible par machine (lignes préfixées, à filtrer du reste du log) :
+//   BENCH_META,platform=...,cpu_mhz=...,samples=...,warmup=...
+//   BENCH,name,unit,ops,min_ns,median_ns,mean_ns,max_ns,stddev_ns,ops_per_s
+//   BENCH_END
+// Comparaison entre commits : grep '^BENCH' avant/après, colonne median_ns.
+
+#ifndef ESPGOTCHI_BENCH_SAMPLES
+#define ESPGOTCHI_BENCH_SAMPLES 15
+#endif
+
+#ifndef ESPGOTCHI_BENCH_WARMUP
+#define ESPGOTCHI_BENCH_WARMUP 3
+#endif
+
+#define TAMA_DISPLAY_FRAMERATE 3
+
+// Trames LCD enregistrées sur la ROM (boot) pour les mesures vidéo
+#define BENCH_FRAMES 16
+#define BENCH_FRAME_BYTES (LCD_HEIGHT * (LCD_WIDTH / 8))
+
+static VideoService video;
+static InputService input;
+static AudioService audio;
+static TamaHost host(video, input);
+
+// Glue audio utilisée par TamaHost
+void espgotchi_hal_set_frequency(u32_t freq)
+{
+  audio.setFrequency(freq);
+}
+
+void espgotchi_hal_play_frequency(bool_t en)
+{
+  if (en)
+    audio.play();
+  else
+    audio.stop();
+}
+
+class EspgotchiBench
+{
+public:
+  void run();
+
+private:
+  uint8_t _frames[BENCH_FRAMES][BENCH_FRAME_BYTES];
+  uint8_t _frameCount = 0;
+  EspgotchiInput _touch;
+
+  // Un échantillon : fn exécute ops opérations et retourne la durée (ns)
+  template <typename Fn>
+  void measure(const char *name, const char *unit, uint32_t ops, Fn fn);
+
+  template <typename Fn>
+  static uint64_t timed(Fn fn);
+
+  void recordFrames();
+  void loadFrame(uint8_t i);
+  void showFrame(uint8_t i);
+};
+
+template <typename Fn>
+uint64_t EspgotchiBench::timed(Fn fn)
+{
+  const int64_t t0 = esp_timer_get_time();
+  fn();
+  return (uint64_t)(esp_timer_get_time() - t0) * 1000ull;
+}
+
+template <typename Fn>
+void EspgotchiBench::measure(const char *name, const char *unit, uint32_t ops, Fn fn)
+{
+  double ns[ESPGOTCHI_BENCH_SAMPLES];
+
+  for (uint8_t i = 0; i < ESPGOTCHI_BENCH_WARMUP; i++)
+    fn();
+  for (uint8_t i = 0; i < ESPGOTCHI_BENCH_SAMPLES; i++)
+    ns[i] = (double)fn() / ops;
+
+  double mean = 0;
+  for (double v : ns)
+    mean += v;
+  mean /= ESPGOTCHI_BENCH_SAMPLES;
+  double var = 0;
+  for (double v : ns)
+    var += (v - mean) * (v - mean);
+  const double stddev = sqrt(var / ESPGOTCHI_BENCH_SAMPLES);
+
+  std::sort(ns, ns + ESPGOTCHI_BENCH_SAMPLES);
+  const double median = ns[ESPGOTCHI_BENCH_SAMPLES / 2];
+
+  Serial.printf("BENCH,%s,%s,%lu,%.1f,%.1f,%.1f,%.1f,%.1f,%.0f\n", name, unit, (unsigned long)ops, ns[0], median,
+                mean, ns[ESPGOTCHI_BENCH_SAMPLES - 1], stddev, median > 0 ? 1e9 / median : 0.0);
+}
+
+void EspgotchiBench::recordFrames()
+{
+  // Animation du boot : une trame à chaque changement de la matrice LCD
+  uint8_t state[VideoService::STATE_SIZE];
+  uint32_t idle;
+  _frameCount = 0;
+  for (uint32_t chunk = 0; chunk < 20000 && _frameCount < BENCH_FRAMES; chunk++)
+  {
+    espgotchi_sched_run(ESPGOTCHI_ENGINE_DECODED, 2000, &idle);
+    video.exportState(state, sizeof(state));
+    if (_frameCount == 0 || memcmp(state, _frames[_frameCount - 1], BENCH_FRAME_BYTES) != 0)
+      memcpy(_frames[_frameCount++], state, BENCH_FRAME_BYTES);
+  }
+}
+
+void EspgotchiBench::loadFrame(uint8_t i)
+{
+  const uint8_t *f = _frames[i % _frameCount];
+  for (u8_t y = 0; y < LCD_HEIGHT; y++)
+    for (u8_t x = 0; x < LCD_WIDTH; x++)
+      video.setLcdMatrix(x, y, (f[y * (LCD_WIDTH / 8) + x / 8] >> (7 - (x % 8))) & 1);
+}
+
+void EspgotchiBench::showFrame(uint8_t i)
+{
+  // Trame côté affichage, sans repasser par l'écran émulé
+  LcdFrame frame;
+  video.captureFrame(frame);
+  memcpy(frame.matrix, _frames[i % _frameCount], BENCH_FRAME_BYTES);
+  video.presentFrame(frame);
+}
+
+void EspgotchiBench::run()
+{
+#ifdef ESPGOTCHI_NATIVE
+  Serial.printf("BENCH_META,platform=native,cpu_mhz=0,samples=%d,warmup=%d\n", ESPGOTCHI_BENCH_SAMPLES,
+                ESPGOTCHI_BENCH_WARMUP);
+#else
+  Serial.printf("BENCH_META,platform=esp32,cpu_mhz=%lu,samples=%d,warmup=%d\n", (unsigned long)getCpuFrequencyMhz(),
+                ESPGOTCHI_BENCH_SAMPLES, ESPGOTCHI_BENCH_WARMUP);
+#endif
+  Serial.println("BENCH,name,unit,ops,min_ns,median_ns,mean_ns,max_ns,stddev_ns,ops_per_s");
+
+  // --- Émulation (ROM réelle, sans cadence : speed 0) ---
+  cpu_set_speed(0);
+  const uint32_t instr = 20000;
+  measure("tamalib_step", "instr", instr, [&] {
+    return timed([&] {
+      for (uint32_t i = 0; i < instr; i++)
+        tamalib_step();
+    });
+  });
+  measure("sched_run_decoded", "instr", instr, [&] {
+    uint32_t idle;
+    return timed([&] { espgotchi_sched_run(ESPGOTCHI_ENGINE_DECODED, instr, &idle); });
+  });
+  measure("sched_run_block", "instr", instr, [&] {
+    uint32_t idle;
+    return timed([&] { espgotchi_sched_run(ESPGOTCHI_ENGINE_BLOCK, instr, &idle); });
+  });
+  measure("rom_unpack", "program", 1, [&] { return timed([] { espgotchi_rebuild_tama_program(); }); });
+
+  // --- Vidéo : trames enregistrées, affichage réel (ESP32) ou enregistreur (natif) ---
+  recordFrames();
+  if (_frameCount < 2)
+  {
+    Serial.println("BENCH_ERROR,video,not enough distinct LCD frames");
+  }
+  else
+  {
+    const uint32_t pixels = LCD_WIDTH * LCD_HEIGHT;
+    measure("video_set_lcd_matrix", "pixel", pixels * _frameCount, [&] {
+      return timed([&] {
+        for (uint8_t i = 0; i < _frameCount; i++)
+          loadFrame(i);
+      });
+    });
+
+    // Trame identique à celle à l'écran : une comparaison par ligne
+    volatile uint32_t sink = 0;
+    measure("video_matrix_unchanged", "frame", 1000, [&] {
+      showFrame(0);
+      video.renderMatrixToTft();
+      return timed([&] {
+        for (uint32_t i = 0; i < 1000; i++)
+          sink = sink + video.matrixUnchanged();
+      });
+    });
+
+    // Trames successives de l'animation : lignes et suites de pixels
+    // modifiées (XOR des lignes, parcours des bits à 1), sans le dessin
+    measure("video_diff_matrix", "frame", _frameCount * 100u, [&] {
+      uint64_t ns = 0;
+      VideoService::LcdDiff diff;
+      for (uint8_t i = 0; i < _frameCount; i++)
+      {
+        showFrame(i);
+        video.updateShades();
+        ns += timed([&] {
+          for (uint32_t k = 0; k < 100; k++)
+            video.diffShades(diff);
+        });
+        sink = sink + diff.rowCount;
+        video.renderMatrixToTft();
+      }
+      return ns;
+    });
+
+    // Mode paresseux : matrice + icônes redécodées depuis la mémoire d'affichage
+    measure("video_decode_vram", "frame", 1000, [&] {
+      return timed([&] {
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+          espgotchi_lcd_dirty = 1;
+          video.syncLcd();
+        }
+      });
+    });
+
+    // Trames successives de l'animation : seuls les pixels modifiés sont
+    // redessinés. Un rendu dure quelques µs : on cumule toute l'animation.
+    measure("video_render_delta", "frame", _frameCount, [&] {
+      uint64_t ns = 0;
+      for (uint8_t i = 0; i < _frameCount; i++)
+      {
+        showFrame(i);
+        ns += timed([] { video.renderMatrixToTft(); });
+      }
+      return ns;
+    });
+
+    // Même animation avec rémanence : un pas de niveaux par rendu, seuls
+    // les pixels dont le gris change sont redessinés
+    measure("video_render_ghost", "frame", _frameCount, [&] {
+      uint64_t ns = 0;
+      video.setGhosting(true);
+      for (uint8_t i = 0; i < _frameCount; i++)
+      {
+        showFrame(i);
+        ns += timed([] { video.renderMatrixToTft(); });
+      }
+      video.setGhosting(false);
+      return ns;
+    });
+
+    // Premier rendu (cadre + fond + tous les pixels allumés)
+    measure("video_render_full", "frame", 1, [&] {
+      uint8_t state[VideoService::STATE_SIZE];
+      video.exportState(state, sizeof(state));
+      video.importState(state, sizeof(state));
+      LcdFrame frame;
+      video.captureFrame(frame);
+      video.presentFrame(frame);
+      return timed([] { video.renderMatrixToTft(); });
+    });
+  }
+
+  // --- Entrée : lecture tactile + anti-rebond (natif : appui simulé sur LEFT) ---
+#ifdef ESPGOTCHI_NATIVE
+  g_nativeTouch.down = true;
+  g_nativeTouch.raw = TS_Point(600, 3400, 800);
+#endif
+  measure("input_read_stable_press", "call", 1000, [&] {
+    return timed([&] {
+      VButton pressed;
+      for (uint32_t i = 0; i < 1000; i++)
+        _touch.readStablePress(pressed);
+    });
+  });
+#ifdef ESPGOTCHI_NATIVE
+  g_nativeTouch.down = false;
+#endif
+
+  Serial.println("BENCH_END");
+}
+
+static EspgotchiBench bench;
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(200);
+
+  video.initDisplay();
+  video.begin();
+  input.begin();
+  video.setInputService(&input);
+  audio.begin();
+  host.begin(TAMA_DISPLAY_FRAMERATE, 1000000);
+
+  bench.run();
+}
+
+void loop()
+{
+  delay(1000);
+}
+
+#ifdef ESPGOTCHI_NATIVE
+int main()
+{
+  setup();
+  return 0;
+}
+#endif
@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <XPT2046_Touchscreen.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#include <time.h>
+#include <unistd.h>
+
+#include "NativePlatform.h"
+
+// Implémentation Linux des shims Arduino/ESP utilisés par les services.
+
+HardwareSerial Serial;
+EspClass ESP;
+NativeTouchState g_nativeTouch;
+
+// Par thread : le thread d'affichage (--dual-core) ne compte pas dans la
+// charge de l'émulation
+static thread_local uint64_t s_sleptUs = 0;
+
+static int64_t monotonicUs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Origine du temps = premier appel, comme esp_timer au boot
+static int64_t s_bootUs = monotonicUs();
+
+extern "C" int64_t esp_timer_get_time(void)
+{
+  return monotonicUs() - s_bootUs;
+}
+
+uint32_t millis()
+{
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+uint32_t micros()
+{
+  return (uint32_t)esp_timer_get_time();
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  if (us == 0)
+    return;
+
+  int64_t start = monotonicUs();
+
+  struct timespec req;
+  req.tv_sec = us / 1000000u;
+  req.tv_nsec = (long)(us % 1000000u) * 1000L;
+  while (nanosleep(&req, &req) != 0)
+  {
+  }
+
+  s_sleptUs += (uint64_t)(monotonicUs() - start);
+}
+
+void delay(uint32_t ms)
+{
+  delayMicroseconds(ms * 1000u);
+}
+
+uint64_t nativeSleptUs()
+{
+  return s_sleptUs;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  (void)pin;
+  (void)val;
+}
+
+uint32_t ledcSetup(uint8_t chan, uint32_t freq, uint8_t bitNum)
+{
+  (void)chan;
+  (void)bitNum;
+  return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t chan)
+{
+  (void)pin;
+  (void)chan;
+}
+
+void ledcWrite(uint8_t chan, uint32_t duty)
+{
+  (void)chan;
+  (void)duty;
+}
+
+uint32_t ledcWriteTone(uint8_t chan, uint32_t freq)
+{
+  (void)chan;
+  return freq;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+size_t Print::printf(const char *fmt, ...)
+{
+  char buf[512];
+
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+
+  if (n < 0)
+    return 0;
+  if ((size_t)n >= sizeof(buf))
+    n = sizeof(buf) - 1;
+
+  return write(buf, (size_t)n);
+}
+
+size_t HardwareSerial::write(const char *buf, size_t len)
+{
+  return fwrite(buf, 1, len, stdout);
+}
+
+void HardwareSerial::flush()
+{
+  fflush(stdout);
+}
+
+// Pas de vue fine du heap sous Linux : on expose des valeurs neutres.
+uint32_t EspClass::getHeapSize() const { return 0; }
+uint32_t EspClass::getFreeHeap() const { return 0; }
+uint32_t EspClass::getMinFreeHeap() const { return 0; }
+uint32_t EspClass::getMaxAllocHeap() const { return 0; }
+
+extern "C" void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+  // Pas de PSRAM en natif : on reproduit le cas "ESP32 sans PSRAM".
+  if (caps & MALLOC_CAP_SPIRAM)
+    return nullptr;
+
+  return malloc(size);
+}
+
+extern "C" void heap_caps_free(void *ptr)
+{
+  free(ptr);
+}
@@ -0,0 +1,310 @@
+#include "NativeLockstep.h"
+
+#include <Arduino.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include "cpu.h"
+#include "../arduinogotchi_core/espgotchi_sched.h"
+#include "../arduinogotchi_core/espgotchi_trace.h"
+}
+
+#include "../VideoService.h"
+#include "../InputService.h"
+#include "../TamaHost.h"
+
+// Fréquence de l'horloge interne du E0C6S46 (ticks par seconde émulée)
+static constexpr uint32_t TAMA_TICK_FREQUENCY = 32768;
+
+// Différences mémoire affichées au plus
+static constexpr uint16_t MAX_MEMORY_DIFFS = 16;
+
+// État comparé, mis à zéro avant remplissage (octets de bourrage compris)
+struct LockstepState
+{
+  uint64_t instr;   // instructions exécutées depuis begin()
+  uint32_t emuTime; // tick_counter + durée due au prochain cpu_step()
+  uint32_t tick;    // tick_counter brut (affiché, pas comparé)
+  uint8_t timeExact; // emuTime exact, sinon majoré (pas comparé)
+  uint32_t callDepth;
+  uint32_t clk[8];
+  uint32_t progTs;
+  uint16_t pc, x, y;
+  uint8_t a, b, np, sp, flags, halted;
+  uint8_t progEnabled, progData, progRld;
+  uint8_t buttons;
+  uint8_t owed; // (affiché, pas comparé)
+  struct
+  {
+    uint8_t factor, mask, triggered, vector;
+  } ints[INT_SLOT_NUM];
+  MEM_BUFFER_TYPE memory[MEM_BUFFER_SIZE];
+  uint8_t video[VideoService::STATE_SIZE];
+};
+
+struct LockstepCmd
+{
+  uint32_t n;      // instructions à exécuter (0 : fin)
+  uint8_t buttons; // boutons appliqués avant le lot
+};
+
+static bool writeFull(int fd, const void *buf, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+  while (len > 0)
+  {
+    const ssize_t w = write(fd, p, len);
+    if (w <= 0)
+      return false;
+    p += w;
+    len -= (size_t)w;
+  }
+  return true;
+}
+
+static bool readFull(int fd, void *buf, size_t len)
+{
+  uint8_t *p = (uint8_t *)buf;
+  while (len > 0)
+  {
+    const ssize_t r = read(fd, p, len);
+    if (r <= 0)
+      return false;
+    p += r;
+    len -= (size_t)r;
+  }
+  return true;
+}
+
+static void capture(LockstepState &s, const TamaHost &host, VideoService &video, const InputService &input)
+{
+  state_t *st = cpu_get_state();
+  u32_t *const clk[8] = {
+      st->clk_timer_2hz_timestamp,  st->clk_timer_4hz_timestamp,  st->clk_timer_8hz_timestamp,
+      st->clk_timer_16hz_timestamp, st->clk_timer_32hz_timestamp, st->clk_timer_64hz_timestamp,
+      st->clk_timer_128hz_timestamp, st->clk_timer_256hz_timestamp,
+  };
+
+  memset(&s, 0, sizeof(s));
+  s.instr = host.stepCount();
+  bool_t exact = 0;
+  s.owed = espgotchi_sched_owed_cycles(&exact);
+  s.timeExact = exact;
+  s.tick = *st->tick_counter;
+  s.emuTime = s.tick + s.owed;
+  s.callDepth = *st->call_depth;
+  for (int i = 0; i < 8; i++)
+    s.clk[i] = *clk[i];
+  s.progTs = *st->prog_timer_timestamp;
+  s.pc = *st->pc;
+  s.x = *st->x;
+  s.y = *st->y;
+  s.a = *st->a;
+  s.b = *st->b;
+  s.np = *st->np;
+  s.sp = *st->sp;
+  s.flags = *st->flags;
+  s.halted = *st->cpu_halted;
+  s.progEnabled = *st->prog_timer_enabled;
+  s.progData = *st->prog_timer_data;
+  s.progRld = *st->prog_timer_rld;
+  s.buttons = input.buttons();
+  for (int i = 0; i < INT_SLOT_NUM; i++)
+  {
+    s.ints[i].factor = st->interrupts[i].factor_flag_reg;
+    s.ints[i].mask = st->interrupts[i].mask_reg;
+    s.ints[i].triggered = st->interrupts[i].triggered;
+    s.ints[i].vector = st->interrupts[i].vector;
+  }
+  memcpy(s.memory, st->memory, sizeof(s.memory));
+  video.exportState(s.video, sizeof(s.video));
+}
+
+// Même état, hors champs informatifs (tick brut, durée due). Le temps émulé
+// n'est comparé que s'il est exact des deux côtés : juste après un
+// chargement ou pendant l'établissement du régime d'arrêt, la durée due
+// n'est qu'un majorant ; les timers, eux, sont toujours comparés.
+static bool sameState(const LockstepState &a, const LockstepState &b)
+{
+  LockstepState x = a, y = b;
+  x.tick = y.tick = 0;
+  x.owed = y.owed = 0;
+  x.timeExact = y.timeExact = 0;
+  if (!a.timeExact || !b.timeExact)
+    x.emuTime = y.emuTime = 0;
+  return memcmp(&x, &y, sizeof(x)) == 0;
+}
+
+static void dumpStates(const LockstepState &ref, const LockstepState &opt)
+{
+  Serial.println("  field        reference   optimised");
+#define LS_FIELD(name, field, fmt)                                                                  \
+  Serial.printf("  %-11s  " fmt "  " fmt "%s\n", name, (unsigned long)ref.field, (unsigned long)opt.field, \
+                ref.field != opt.field ? "  *" : "")
+  LS_FIELD("PC", pc, "%10lX");
+  LS_FIELD("A", a, "%10lX");
+  LS_FIELD("B", b, "%10lX");
+  LS_FIELD("X", x, "%10lX");
+  LS_FIELD("Y", y, "%10lX");
+  LS_FIELD("NP", np, "%10lX");
+  LS_FIELD("SP", sp, "%10lX");
+  LS_FIELD("flags", flags, "%10lX");
+  LS_FIELD("halted", halted, "%10lu");
+  LS_FIELD("call_depth", callDepth, "%10lu");
+  LS_FIELD("time", emuTime, "%10lu");
+  LS_FIELD("time exact", timeExact, "%10lu");
+  LS_FIELD("tick", tick, "%10lu");
+  LS_FIELD("owed", owed, "%10lu");
+  for (int i = 0; i < 8; i++)
+  {
+    char name[16];
+    snprintf(name, sizeof(name), "clk[%d]", i);
+    LS_FIELD(name, clk[i], "%10lu");
+  }
+  LS_FIELD("prog_ts", progTs, "%10lu");
+  LS_FIELD("prog_en", progEnabled, "%10lu");
+  LS_FIELD("prog_data", progData, "%10lX");
+  LS_FIELD("prog_rld", progRld, "%10lX");
+  LS_FIELD("buttons", buttons, "%10lX");
+  for (int i = 0; i < INT_SLOT_NUM; i++)
+  {
+    char name[16];
+    snprintf(name, sizeof(name), "int[%d].f/m/t", i);
+    const unsigned long r = (ref.ints[i].factor << 8) | (ref.ints[i].mask << 4) | ref.ints[i].triggered;
+    const unsigned long o = (opt.ints[i].factor << 8) | (opt.ints[i].mask << 4) | opt.ints[i].triggered;
+    Serial.printf("  %-11s  %10lX  %10lX%s\n", name, r, o, r != o ? "  *" : "");
+  }
+#undef LS_FIELD
+
+  uint32_t diffs = 0;
+  for (uint32_t i = 0; i < MEM_BUFFER_SIZE; i++)
+  {
+    if (ref.memory[i] == opt.memory[i])
+      continue;
+    if (diffs++ < MAX_MEMORY_DIFFS)
+      Serial.printf("  mem[%03lX]     %10X  %10X  *\n", (unsigned long)i, ref.memory[i], opt.memory[i]);
+  }
+  if (diffs)
+    Serial.printf("  memory: %lu cells differ\n", (unsigned long)diffs);
+
+  uint32_t lcd = 0;
+  for (size_t i = 0; i < sizeof(ref.video); i++)
+    lcd += ref.video[i] != opt.video[i];
+  if (lcd)
+    Serial.printf("  LCD: %lu bytes differ (matrix + icons)\n", (unsigned long)lcd);
+}
+
+int nativeLockstep(TamaHost &host, VideoService &video, InputService &input, espgotchi_engine_t engine,
+                   uint32_t batch, uint32_t seconds)
+{
+  if (engine == ESPGOTCHI_ENGINE_TAMALIB || batch == 0)
+  {
+    Serial.println("[Lockstep] needs --engine decoded|block and a batch >= 1");
+    return 2;
+  }
+
+  // Sans cadence des deux côtés : la référence ne doit pas dormir dans cpu_step()
+  host.setTimeMult(TIME_MULT_MAX);
+
+  int cmdPipe[2], statePipe[2];
+  if (pipe(cmdPipe) != 0 || pipe(statePipe) != 0)
+    return 2;
+  fflush(stdout);
+
+  const pid_t pid = fork();
+  if (pid < 0)
+    return 2;
+
+  if (pid == 0)
+  {
+    // Référence : muette, exécute ce que le parent a exécuté
+    freopen("/dev/null", "w", stdout);
+    close(cmdPipe[1]);
+    close(statePipe[0]);
+    host.stopInputReplay();
+    host.setEngine(ESPGOTCHI_ENGINE_TAMALIB);
+    host.setTimeMult(TIME_MULT_MAX);
+
+    LockstepCmd cmd;
+    LockstepState s;
+    while (readFull(cmdPipe[0], &cmd, sizeof(cmd)) && cmd.n != 0)
+    {
+      input.setButtons(cmd.buttons);
+      uint32_t done = 0;
+      while (done < cmd.n)
+        done += host.runInstructions(cmd.n - done);
+      capture(s, host, video, input);
+      if (!writeFull(statePipe[1], &s, sizeof(s)))
+        break;
+    }
+    _exit(0);
+  }
+
+  close(cmdPipe[0]);
+  close(statePipe[1]);
+  host.setEngine(engine);
+  host.setTimeMult(TIME_MULT_MAX);
+
+  const bool replay = host.inputReplaying();
+  const u32_t tick0 = *cpu_get_state()->tick_counter;
+  const uint64_t instr0 = host.stepCount();
+  Serial.printf("[Lockstep] reference=tamalib optimised=%s, compare every %lu instr, until %s\n",
+                engine == ESPGOTCHI_ENGINE_BLOCK ? "block" : "decoded", (unsigned long)batch,
+                replay ? "end of input replay" : "--seconds emulated");
+
+  static LockstepState ref, opt;
+  uint64_t compares = 0, timed = 0;
+  int status = 0;
+  for (;;)
+  {
+    if (replay ? !host.inputReplaying()
+               : *cpu_get_state()->tick_counter - tick0 >= (uint64_t)seconds * TAMA_TICK_FREQUENCY)
+      break;
+
+    const u13_t pc = *cpu_get_state()->pc;
+    LockstepCmd cmd = {};
+    cmd.n = host.runInstructions(batch);
+    cmd.buttons = input.buttons();
+    capture(opt, host, video, input);
+
+    if (!writeFull(cmdPipe[1], &cmd, sizeof(cmd)) || !readFull(statePipe[0], &ref, sizeof(ref)))
+    {
+      Serial.println("[Lockstep] reference process lost");
+      status = 2;
+      break;
+    }
+    compares++;
+    timed += ref.timeExact && opt.timeExact;
+
+    if (!sameState(ref, opt))
+    {
+      Serial.printf("[Lockstep] DIVERGENCE after %llu instructions (batch of %lu from PC %04X)\n",
+                    (unsigned long long)(opt.instr - instr0), (unsigned long)cmd.n, pc);
+      dumpStates(ref, opt);
+      if (espgotchi_trace_count())
+        host.printTrace(cmd.n + 8);
+      status = 1;
+      break;
+    }
+  }
+
+  const LockstepCmd quit = {};
+  writeFull(cmdPipe[1], &quit, sizeof(quit));
+  close(cmdPipe[1]);
+  close(statePipe[0]);
+  if (status != 0)
+    kill(pid, SIGTERM);
+  waitpid(pid, nullptr, 0);
+
+  if (status == 0)
+    Serial.printf("[Lockstep] OK: %llu instructions, %.1fs emulated, %llu comparisons (%llu with time)\n",
+                  (unsigned long long)(host.stepCount() - instr0),
+                  (double)(*cpu_get_state()->tick_counter - tick0) / TAMA_TICK_FREQUENCY,
+                  (unsigned long long)compares, (unsigned long long)timed);
+  return status;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+extern "C"
+{
+#include "../arduinogotchi_core/espgotchi_cpu_fast.h"
+}
+
+class TamaHost;
+class VideoService;
+class InputService;
+
+// Exécution différentielle (cible native) : fork() en deux instances parties
+// du même état (ROM, save-state, journal d'entrées déjà chargés). L'enfant
+// exécute la référence (pas TamaLIB seuls), le parent le moteur optimisé ;
+// après chaque lot de batch instructions (1 = chaque instruction), le parent
+// compare registres, timers, interruptions, mémoire, écran LCD et boutons,
+// et s'arrête à la première divergence en affichant les deux états.
+// Les transitions de boutons rejouées par le parent sont transmises à
+// l'enfant au même numéro d'instruction.
+// Fin : fin du rejeu d'entrées s'il y en a un, sinon seconds secondes émulées.
+// Retourne 0 sans divergence, 1 à la première divergence, 2 sur erreur.
+int nativeLockstep(TamaHost &host, VideoService &video, InputService &input, espgotchi_engine_t engine,
+                   uint32_t batch, uint32_t seconds);
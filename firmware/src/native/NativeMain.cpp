@@ -0,0 +1,648 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <ctype.h>
+#include <atomic>
+#include <thread>
+
+extern "C"
+{
+#include "tamalib.h"
+#include "cpu.h"
+#include "../arduinogotchi_core/espgotchi_profile.h"
+#include "../arduinogotchi_core/espgotchi_tama_rom.h"
+#include "../arduinogotchi_core/espgotchi_trace.h"
+}
+
+#include "../VideoService.h"
+#include "../InputService.h"
+#include "../AudioService.h"
+#include "../TamaHost.h"
+#include "../SaveStateService.h"
+#include "../WallClock.h"
+#include "../LcdStream.h"
+#include "NativeLockstep.h"
+#include "NativePlatform.h"
+
+// Point d'entrée de la cible [env:native] : même câblage que TamaApp_Headless,
+// mais sans splash ni bip, et avec un rapport de perfs en fin d'exécution.
+//
+// Usage : program [--seconds N] [--speed 1|2|4|8|max] [--engine block|decoded|tamalib]
+//                 [--ppm fichier.ppm] [--state fichier.log] [--checkpoint-ms N]
+//                 [--wall-offset S] [--catchup-budget-ms N]
+//                 [--profile préfixe] [--trace fichier.trc]
+//                 [--record fichier.inp] [--replay fichier.inp|log_serie.txt]
+//                 [--lockstep N] [--lcd lazy|pixel] [--ghost] [--lcd-stream] [--dual-core]
+//        program --decode-trace fichier.trc|log_serie.txt
+//        program --decode-lcd log_serie.txt préfixe
+//
+// --state : journal de checkpoints (image de partition) ; reprend le dernier
+//           checkpoint s'il existe (et rattrape le temps écoulé depuis), puis en
+//           ajoute un en fin d'exécution.
+// --checkpoint-ms : ajoute aussi un checkpoint toutes les N ms (temps réel).
+// --wall-offset : avance l'heure murale de S secondes, comme si l'appareil
+//           était resté éteint S secondes depuis le dernier checkpoint.
+// --catchup-budget-ms : plafond du rattrapage (ESPGOTCHI_CATCHUP_BUDGET_MS) ;
+//           code de sortie 1 si le rattrapage est incomplet.
+// --profile : (build -D ESPGOTCHI_PROFILE=1) écrit <préfixe>_ops.csv (par
+//             classe d'opcode) et <préfixe>_pc.csv (par adresse ROM).
+// --trace : (build -D ESPGOTCHI_TRACE=1) écrit l'anneau de trace en fin
+//           d'exécution ("EGTR", nombre, enregistrements w0/w1 petit-boutistes).
+// --record : journal d'entrées de toute la session (voir InputRecorder),
+//           écrit en fin d'exécution.
+// --replay : rejoue un journal (fichier --record, ou log série contenant les
+//           lignes "IR ..." de "input dump") jusqu'à sa fin, --seconds ignoré ;
+//           code de sortie 1 si un tick ou une empreinte d'écran diffère.
+// --lockstep : compare le moteur --engine (decoded|block) à TamaLIB seul,
+//           toutes les N instructions (1 = chaque instruction), sur --seconds
+//           secondes émulées ou jusqu'à la fin de --replay ; code de sortie 1
+//           et dump des deux états à la première divergence (NativeLockstep).
+// --lcd : décodage de l'écran LCD une fois par trame (lazy, défaut
+//           ESPGOTCHI_LCD_LAZY) ou callbacks HAL pixel par pixel (pixel).
+// --ghost : rémanence de l'écran LCD (VideoService::setGhosting()).
+// --lcd-stream : flux série de l'écran LCD (lignes "LS ..." sur la sortie,
+//           au milieu des logs), débit affiché en fin d'exécution.
+// --dual-core : affichage, tactile et son dans un second thread
+//           (TamaHost::uiLoopOnce()), comme la tâche du cœur 0 sur l'ESP32.
+// --decode-trace : désassemble une trace (fichier --trace, ou log série de
+//           l'ESP32 contenant les lignes "TR w0 w1" de "trace dump") et quitte.
+// --decode-lcd : reconstruit les images d'un flux LCD (log série ou sortie de
+//           --lcd-stream) en <préfixe>_NNNNN.ppm et quitte.
+
+/**** Tama Setting ****/
+#define TAMA_DISPLAY_FRAMERATE 3
+
+// Fréquence de l'horloge interne du E0C6S46 (ticks par seconde émulée)
+#define TAMA_TICK_FREQUENCY 32768u
+
+static VideoService video;
+static InputService input;
+static AudioService audio;
+static TamaHost host(video, input);
+static SaveStateService saves;
+
+// Glue audio utilisée par TamaHost (AudioService natif = LEDC sans effet)
+void espgotchi_hal_set_frequency(u32_t freq)
+{
+  audio.setFrequency(freq);
+}
+
+void espgotchi_hal_play_frequency(bool_t en)
+{
+  if (en)
+    audio.play();
+  else
+    audio.stop();
+}
+
+// CSV du profileur : exécutions et cycles par classe d'opcode et par adresse ROM
+static bool writeProfileCsv(const char *prefix)
+{
+  char path[256];
+
+  snprintf(path, sizeof(path), "%s_ops.csv", prefix);
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  static espgotchi_profile_op_t ops[ESPGOTCHI_OP_COUNT];
+  espgotchi_profile_get_ops(ops);
+  fprintf(f, "opcode,count,cycles\n");
+  for (uint8_t k = 0; k < ESPGOTCHI_OP_COUNT; k++)
+  {
+    if (ops[k].count)
+      fprintf(f, "\"%s\",%llu,%llu\n", espgotchi_op_name(k), (unsigned long long)ops[k].count,
+              (unsigned long long)ops[k].cycles);
+  }
+  fclose(f);
+
+  snprintf(path, sizeof(path), "%s_pc.csv", prefix);
+  f = fopen(path, "w");
+  if (!f)
+    return false;
+  const espgotchi_decoded_op_t *prog = espgotchi_get_tama_decoded_program();
+  const u32_t words = espgotchi_get_tama_program_word_count();
+  fprintf(f, "pc,opcode,count,cycles\n");
+  for (u32_t pc = 0; pc < words; pc++)
+  {
+    const u32_t n = espgotchi_profile_pc_count((u13_t)pc);
+    if (n)
+      fprintf(f, "0x%04X,\"%s\",%lu,%llu\n", (unsigned)pc, espgotchi_op_name(prog[pc].kind), (unsigned long)n,
+              (unsigned long long)n * prog[pc].cycles);
+  }
+  fclose(f);
+  return true;
+}
+
+// Trace : fichier binaire ("EGTR" + nombre + enregistrements)
+static bool writeTraceFile(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+
+  const u32_t n = espgotchi_trace_count();
+  bool ok = fwrite("EGTR", 1, 4, f) == 4 && fwrite(&n, 4, 1, f) == 1;
+  for (u32_t i = 0; ok && i < n; i++)
+  {
+    const espgotchi_trace_rec_t *rec = espgotchi_trace_get(i);
+    ok = fwrite(&rec->w0, 4, 1, f) == 1 && fwrite(&rec->w1, 4, 1, f) == 1;
+  }
+  return fclose(f) == 0 && ok;
+}
+
+// Trace : fichier binaire, ou log série avec des lignes "TR w0 w1"
+static int decodeTraceFile(const char *path)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+  {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+
+  char magic[4];
+  const bool binary = fread(magic, 1, 4, f) == 4 && !memcmp(magic, "EGTR", 4);
+  u32_t count = 0;
+  if (binary && fread(&count, 4, 1, f) != 1)
+    count = 0;
+  if (!binary)
+    rewind(f);
+
+  espgotchi_trace_rec_t rec, prev;
+  char line[256];
+  u32_t n = 0;
+  for (;;)
+  {
+    if (binary)
+    {
+      if (n >= count || fread(&rec.w0, 4, 1, f) != 1 || fread(&rec.w1, 4, 1, f) != 1)
+        break;
+    }
+    else
+    {
+      if (!fgets(line, sizeof(line), f))
+        break;
+      unsigned long w0, w1;
+      if (sscanf(line, "TR %lx %lx", &w0, &w1) != 2)
+        continue;
+      rec.w0 = (u32_t)w0;
+      rec.w1 = (u32_t)w1;
+    }
+
+    espgotchi_trace_format(&rec, n ? &prev : nullptr, line, sizeof(line));
+    printf("%8lu  %s\n", (unsigned long)n, line);
+    prev = rec;
+    n++;
+  }
+  fclose(f);
+  return n ? 0 : 1;
+}
+
+// Image du flux LCD en PPM : icônes sur une bande au-dessus de la matrice,
+// pixels LCD agrandis x8 (256 x 144)
+static bool writeLcdPpm(const char *path, const uint8_t frame[LcdStream::FRAME_BYTES])
+{
+  const int scale = 8;
+  const int iconH = 16;
+  const int w = LCD_WIDTH * scale;
+  const int h = iconH + LCD_HEIGHT * scale;
+  const uint8_t bg[3] = {0xD3, 0xD3, 0xD3};
+  const uint8_t on[3] = {0x00, 0x00, 0x00};
+  const uint8_t icons = frame[LcdStream::FRAME_BYTES - 1];
+
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  fprintf(f, "P6\n%d %d\n255\n", w, h);
+  for (int y = 0; y < h; y++)
+  {
+    for (int x = 0; x < w; x++)
+    {
+      bool lit;
+      if (y < iconH)
+      {
+        // Une case par icône, marge de 4 pixels
+        const int slotW = w / ICON_NUM;
+        lit = ((icons >> (x / slotW)) & 1) && x % slotW >= 4 && x % slotW < slotW - 4 && y >= 4 && y < iconH - 4;
+      }
+      else
+      {
+        const int lx = x / scale;
+        const int ly = (y - iconH) / scale;
+        lit = (frame[ly * (LCD_WIDTH / 8) + lx / 8] >> (7 - lx % 8)) & 1;
+      }
+      fwrite(lit ? on : bg, 1, 3, f);
+    }
+  }
+  return fclose(f) == 0;
+}
+
+// Flux LCD : lignes "LS <hex>" d'un log série, une image PPM par image décodée
+static int decodeLcdStream(const char *path, const char *prefix)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+  {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+
+  LcdStream stream;
+  uint8_t frame[LcdStream::FRAME_BYTES];
+  char line[512];
+  u32_t lines = 0;
+  while (fgets(line, sizeof(line), f))
+  {
+    const char *p = strstr(line, "LS ");
+    if (!p)
+      continue;
+    uint8_t packet[LcdStream::MAX_PACKET];
+    size_t n = 0;
+    for (p += 3; isxdigit((unsigned char)p[0]) && isxdigit((unsigned char)p[1]) && n < sizeof(packet); p += 2)
+    {
+      char hex[3] = {p[0], p[1], 0};
+      packet[n++] = (uint8_t)strtoul(hex, nullptr, 16);
+    }
+    lines++;
+    if (!stream.decode(packet, n, frame))
+      continue;
+
+    char name[512];
+    snprintf(name, sizeof(name), "%s_%05lu.ppm", prefix, (unsigned long)(stream.stats().packets - 1));
+    if (!writeLcdPpm(name, frame))
+    {
+      fprintf(stderr, "cannot write %s\n", name);
+      fclose(f);
+      return 1;
+    }
+  }
+  fclose(f);
+
+  const LcdStreamStats &st = stream.stats();
+  printf("%lu lines, %lu frames (%lu keyframes), %lu errors, %lu bytes -> %s_*.ppm\n", (unsigned long)lines,
+         (unsigned long)st.packets, (unsigned long)st.keyframes, (unsigned long)st.errors, (unsigned long)st.bytes,
+         prefix);
+  return st.packets ? 0 : 1;
+}
+
+// Journal d'entrées : fichier binaire ("EGIR..."), ou log série avec des lignes "IR hex"
+static size_t readInputLog(const char *path, uint8_t *buf, size_t cap)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return 0;
+
+  size_t n = fread(buf, 1, cap, f);
+  if (n < 4 || memcmp(buf, "EGIR", 4) != 0)
+  {
+    rewind(f);
+    n = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+    {
+      if (strncmp(line, "IR ", 3) != 0)
+        continue;
+      for (const char *p = line + 3; isxdigit((unsigned char)p[0]) && isxdigit((unsigned char)p[1]) && n < cap; p += 2)
+      {
+        char hex[3] = {p[0], p[1], 0};
+        buf[n++] = (uint8_t)strtoul(hex, nullptr, 16);
+      }
+    }
+  }
+  fclose(f);
+  return n;
+}
+
+static void printUsage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [--seconds N] [--speed 1|2|4|8|max] [--engine block|decoded|tamalib] [--ppm file.ppm] [--state file.log] [--checkpoint-ms N] [--wall-offset S] [--catchup-budget-ms N] [--profile prefix] [--trace file.trc] [--record file.inp] [--replay file.inp] [--lockstep N] [--lcd lazy|pixel] [--ghost] [--lcd-stream] [--dual-core] | --decode-trace file | --decode-lcd file prefix\n", prog);
+}
+
+// Seuls x1/x2/x4/x8 et max sont acceptés : toute autre valeur tronquée en
+// uint8_t donnerait 0 (= max), un débordement ou un throttle inexact.
+static bool parseSpeed(const char *v, uint8_t &speed)
+{
+  if (!strcmp(v, "max"))
+  {
+    speed = TIME_MULT_MAX;
+    return true;
+  }
+  static const char *const allowed[] = {"1", "2", "4", "8"};
+  for (const char *a : allowed)
+  {
+    if (!strcmp(v, a))
+    {
+      speed = (uint8_t)(a[0] - '0');
+      return true;
+    }
+  }
+  return false;
+}
+
+// Moteur nommé explicitement : une faute de frappe ne doit pas faire tourner
+// lockstep ou profil sur un autre moteur que celui demandé.
+static bool parseEngine(const char *v, espgotchi_engine_t &engine)
+{
+  static const struct
+  {
+    const char *name;
+    espgotchi_engine_t engine;
+  } engines[] = {
+      {"block", ESPGOTCHI_ENGINE_BLOCK},
+      {"decoded", ESPGOTCHI_ENGINE_DECODED},
+      {"tamalib", ESPGOTCHI_ENGINE_TAMALIB},
+  };
+  for (const auto &e : engines)
+  {
+    if (!strcmp(v, e.name))
+    {
+      engine = e.engine;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t seconds = 10;
+  uint8_t speed = 1;
+  const char *ppmPath = nullptr;
+  const char *statePath = nullptr;
+  uint32_t checkpointMs = 0;
+  uint32_t catchUpBudgetMs = ESPGOTCHI_CATCHUP_BUDGET_MS;
+  CatchUpResult catchUp = {0, 0, 0, 0};
+  const char *profilePrefix = nullptr;
+  const char *tracePath = nullptr;
+  const char *recordPath = nullptr;
+  const char *replayPath = nullptr;
+  uint32_t lockstep = 0;
+  int lcdLazy = -1;
+  bool dualCore = false;
+  bool ghost = false;
+  bool lcdStream = false;
+  espgotchi_engine_t engine = (espgotchi_engine_t)ESPGOTCHI_CPU_ENGINE;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--seconds") && i + 1 < argc)
+    {
+      seconds = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    }
+    else if (!strcmp(argv[i], "--speed") && i + 1 < argc)
+    {
+      if (!parseSpeed(argv[++i], speed))
+      {
+        printUsage(argv[0]);
+        return 2;
+      }
+    }
+    else if (!strcmp(argv[i], "--engine") && i + 1 < argc)
+    {
+      if (!parseEngine(argv[++i], engine))
+      {
+        printUsage(argv[0]);
+        return 2;
+      }
+    }
+    else if (!strcmp(argv[i], "--ppm") && i + 1 < argc)
+    {
+      ppmPath = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--state") && i + 1 < argc)
+    {
+      statePath = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--checkpoint-ms") && i + 1 < argc)
+    {
+      checkpointMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    }
+    else if (!strcmp(argv[i], "--wall-offset") && i + 1 < argc)
+    {
+      WallClock::advance((uint32_t)strtoul(argv[++i], nullptr, 10));
+    }
+    else if (!strcmp(argv[i], "--catchup-budget-ms") && i + 1 < argc)
+    {
+      catchUpBudgetMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    }
+    else if (!strcmp(argv[i], "--profile") && i + 1 < argc)
+    {
+      profilePrefix = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+    {
+      tracePath = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--record") && i + 1 < argc)
+    {
+      recordPath = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+    {
+      replayPath = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--lockstep") && i + 1 < argc)
+    {
+      lockstep = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    }
+    else if (!strcmp(argv[i], "--lcd") && i + 1 < argc)
+    {
+      lcdLazy = strcmp(argv[++i], "pixel") ? 1 : 0;
+    }
+    else if (!strcmp(argv[i], "--dual-core"))
+    {
+      dualCore = true;
+    }
+    else if (!strcmp(argv[i], "--ghost"))
+    {
+      ghost = true;
+    }
+    else if (!strcmp(argv[i], "--lcd-stream"))
+    {
+      lcdStream = true;
+    }
+    else if (!strcmp(argv[i], "--decode-trace") && i + 1 < argc)
+    {
+      return decodeTraceFile(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "--decode-lcd") && i + 2 < argc)
+    {
+      return decodeLcdStream(argv[i + 1], argv[i + 2]);
+    }
+    else
+    {
+      printUsage(argv[0]);
+      return 2;
+    }
+  }
+
+  input.begin();
+  video.setInputService(&input);
+  video.initDisplay();
+  video.begin();
+  if (ghost)
+    video.setGhosting(true);
+  if (lcdStream)
+    video.setLcdStream(true);
+  audio.begin();
+
+  host.setEngine(engine);
+  host.begin(TAMA_DISPLAY_FRAMERATE, 1000000);
+  if (lcdLazy >= 0)
+    host.setLcdLazy(lcdLazy != 0);
+  if (speed != 1)
+    host.setTimeMult(speed);
+
+  if (statePath)
+  {
+    saves.begin(statePath);
+    if (saves.load(host))
+      catchUp = host.catchUp(catchUpBudgetMs);
+  }
+
+  if (replayPath)
+  {
+    static uint8_t buf[64 * 1024];
+    const size_t len = readInputLog(replayPath, buf, sizeof(buf));
+    if (!host.loadInputRecording(buf, len) || !host.startInputReplay())
+    {
+      Serial.printf("[Native] cannot replay %s\n", replayPath);
+      return 2;
+    }
+  }
+  else if (recordPath && !host.startInputRecording())
+    return 2;
+
+  if (lockstep)
+    return nativeLockstep(host, video, input, engine, lockstep, seconds);
+
+  state_t *st = cpu_get_state();
+  const u32_t tick0 = *st->tick_counter;
+  const uint64_t slept0 = nativeSleptUs();
+  const int64_t t0 = esp_timer_get_time();
+  const int64_t tEnd = t0 + (int64_t)seconds * 1000000LL;
+
+  const uint64_t steps0 = host.stepCount();
+  const uint64_t idle0 = host.idleTicks();
+
+  // Thread d'affichage : vide ses files une dernière fois avant de s'arrêter
+  std::atomic<bool> uiStop{false};
+  std::thread ui;
+  if (dualCore && host.startDualCore())
+  {
+    ui = std::thread([&] {
+      while (!uiStop.load(std::memory_order_relaxed))
+      {
+        host.uiLoopOnce();
+        delay(ESPGOTCHI_UI_POLL_MS);
+      }
+      host.uiLoopOnce();
+    });
+  }
+
+  uint32_t lastCheckpointMs = millis();
+  while (replayPath ? host.inputReplaying() : esp_timer_get_time() < tEnd)
+  {
+    host.loopOnce();
+
+    if (statePath && checkpointMs && millis() - lastCheckpointMs >= checkpointMs)
+    {
+      lastCheckpointMs = millis();
+      saves.save(host);
+    }
+  }
+  if (ui.joinable())
+  {
+    uiStop.store(true, std::memory_order_relaxed);
+    ui.join();
+  }
+  const uint64_t steps = host.stepCount() - steps0;
+  const uint64_t idleTicks = host.idleTicks() - idle0;
+
+  const int64_t wallUs = esp_timer_get_time() - t0;
+  const uint64_t sleptUs = nativeSleptUs() - slept0;
+  const uint64_t busyUs = (uint64_t)wallUs > sleptUs ? (uint64_t)wallUs - sleptUs : 1;
+  const u32_t ticks = *st->tick_counter - tick0;
+  const double emuSeconds = (double)ticks / TAMA_TICK_FREQUENCY;
+
+  const NativeTftStats &tft = video.tftStats();
+
+  Serial.printf("[Native] wall=%.3fs busy=%.3fs emulated=%.3fs ratio=x%.2f\n",
+                wallUs / 1e6, busyUs / 1e6, emuSeconds, emuSeconds / (wallUs / 1e6));
+  Serial.printf("[Native] steps=%llu  ips(wall)=%.0f  ips(busy)=%.0f\n",
+                (unsigned long long)steps, steps / (wallUs / 1e6), steps / (busyUs / 1e6));
+  Serial.printf("[Native] halt skipped=%.3fs (%.1f%% of emulated)\n",
+                (double)idleTicks / TAMA_TICK_FREQUENCY, ticks ? idleTicks * 100.0 / ticks : 0.0);
+  Serial.printf("[Native] tft primitives=%u pixels=%u (dma %u) chars=%u\n",
+                tft.primitives, tft.pixels, tft.dmaPixels, tft.textChars);
+
+  if (lcdStream)
+  {
+    // Sur le fil : "LS " + 2 caractères hex par octet + fin de ligne
+    const LcdStreamStats &ls = video.lcdStreamStats();
+    const double wire = ls.packets * 4.0 + ls.bytes * 2.0;
+    Serial.printf("[Native] lcd stream: %u packets (%u keyframes), %u bytes, %.0f B/s on the wire (%.2f%% of 115200 baud)\n",
+                  ls.packets, ls.keyframes, ls.bytes, wire / (wallUs / 1e6), wire * 10.0 / (wallUs / 1e6) / 115200.0 * 100.0);
+  }
+
+  if (statePath && !saves.save(host))
+    Serial.printf("[Native] save-state FAILED (%s)\n", statePath);
+  if (statePath)
+    saves.printStats();
+
+  int status = 0;
+  if (catchUp.doneS + catchUp.jumpS < catchUp.gapS)
+  {
+    Serial.printf("[Native] catch-up incomplete: %us of %us\n", catchUp.doneS + catchUp.jumpS, catchUp.gapS);
+    status = 1;
+  }
+  if (replayPath)
+  {
+    const InputReplayStats &rs = host.inputReplayStats();
+    if (rs.late || rs.hashMismatches || !rs.endHashOk)
+      status = 1;
+  }
+
+  if (recordPath)
+  {
+    host.stopInputRecording();
+    static uint8_t buf[64 * 1024];
+    const size_t len = host.saveInputRecording(buf, sizeof(buf));
+    FILE *f = len ? fopen(recordPath, "wb") : nullptr;
+    bool ok = f && fwrite(buf, 1, len, f) == len;
+    if (f)
+      ok = fclose(f) == 0 && ok;
+    if (ok)
+      Serial.printf("[Native] input log (%u bytes) -> %s\n", (unsigned)len, recordPath);
+    else
+      Serial.printf("[Native] input log FAILED (%s)\n", recordPath);
+  }
+
+  if (profilePrefix)
+  {
+    if (!espgotchi_profile_enabled())
+      Serial.println("[Native] profiler not compiled in (-D ESPGOTCHI_PROFILE=1)");
+    else if (writeProfileCsv(profilePrefix))
+    {
+      host.printProfile();
+      Serial.printf("[Native] profile -> %s_ops.csv, %s_pc.csv\n", profilePrefix, profilePrefix);
+    }
+  }
+
+  if (tracePath)
+  {
+    if (espgotchi_trace_count() == 0)
+      Serial.println("[Native] trace not compiled in (-D ESPGOTCHI_TRACE=1)");
+    else if (writeTraceFile(tracePath))
+      Serial.printf("[Native] trace (%lu records) -> %s\n", (unsigned long)espgotchi_trace_count(), tracePath);
+  }
+
+  if (ppmPath)
+  {
+    if (video.saveScreenshot(ppmPath))
+      Serial.printf("[Native] screenshot -> %s\n", ppmPath);
+    else
+      Serial.printf("[Native] screenshot FAILED (%s)\n", ppmPath);
+  }
+
+  return status;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+// Compteurs propres à la cible native (en complément des shims Arduino/ESP).
+
+// Temps total passé dans delay()/delayMicroseconds() par le thread appelant
+// depuis le démarrage (us).
+// wall - slept = temps réellement consommé par l'émulation + le rendu.
+uint64_t nativeSleptUs();
@@ -0,0 +1,208 @@
+#include <TFT_eSPI.h>
+
+// Écran en mémoire pour la cible native (voir include/TFT_eSPI.h).
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
+    : _physW(w), _physH(h), _w(w), _h(h)
+{
+  _fb = new uint16_t[(size_t)w * h];
+  memset(_fb, 0, sizeof(uint16_t) * (size_t)w * h);
+}
+
+void TFT_eSPI::init()
+{
+  resetStats();
+}
+
+void TFT_eSPI::setRotation(uint8_t r)
+{
+  // Rotation 1/3 = paysage, comme sur le CYD
+  if (r & 1)
+  {
+    _w = _physH;
+    _h = _physW;
+  }
+  else
+  {
+    _w = _physW;
+    _h = _physH;
+  }
+}
+
+void TFT_eSPI::fillScreen(uint32_t color)
+{
+  fillRect(0, 0, _w, _h, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+  _stats.primitives++;
+
+  // Clipping identique à TFT_eSPI
+  if (x < 0)
+  {
+    w += x;
+    x = 0;
+  }
+  if (y < 0)
+  {
+    h += y;
+    y = 0;
+  }
+  if (x + w > _w)
+    w = _w - x;
+  if (y + h > _h)
+    h = _h - y;
+  if (w <= 0 || h <= 0)
+    return;
+
+  for (int32_t j = y; j < y + h; j++)
+  {
+    uint16_t *row = _fb + (size_t)j * _w;
+    for (int32_t i = x; i < x + w; i++)
+    {
+      row[i] = (uint16_t)color;
+    }
+  }
+
+  _stats.pixels += (uint32_t)(w * h);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color);
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+  fillRect(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+  fillRect(x, y, 1, h, color);
+}
+
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+  _stats.primitives++;
+  _winX = x;
+  _winY = y;
+  _winW = w > 0 ? w : 0;
+  _winH = h > 0 ? h : 0;
+  _curX = x;
+  _curY = y;
+}
+
+void TFT_eSPI::pushPixel(uint16_t color)
+{
+  if (_winW == 0 || _winH == 0)
+    return;
+  if (_curX >= 0 && _curY >= 0 && _curX < _w && _curY < _h)
+    _fb[(size_t)_curY * _w + _curX] = color;
+  _stats.pixels++;
+
+  // Ordre raster ; au-delà de la fenêtre, reprise en haut à gauche (comme le contrôleur)
+  if (++_curX == _winX + _winW)
+  {
+    _curX = _winX;
+    if (++_curY == _winY + _winH)
+      _curY = _winY;
+  }
+}
+
+void TFT_eSPI::pushColor(uint16_t color, uint32_t len)
+{
+  while (len--)
+    pushPixel(color);
+}
+
+void TFT_eSPI::pushColors(uint16_t *data, uint32_t len, bool swap)
+{
+  // Octets permutés pour le bus SPI seulement : sans objet en mémoire
+  (void)swap;
+  for (uint32_t i = 0; i < len; i++)
+    pushPixel(data[i]);
+}
+
+void TFT_eSPI::pushPixelsDMA(uint16_t *image, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; i++)
+    pushPixel((uint16_t)((image[i] >> 8) | (image[i] << 8)));
+  _stats.dmaPixels += len;
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+{
+  setAddrWindow(x, y, w, h);
+  const uint32_t len = (uint32_t)(w > 0 ? w : 0) * (uint32_t)(h > 0 ? h : 0);
+  for (uint32_t i = 0; i < len; i++)
+    pushPixel((uint16_t)((data[i] >> 8) | (data[i] << 8)));
+}
+
+void TFT_eSPI::setTextColor(uint16_t fg, uint16_t bg)
+{
+  (void)fg;
+  (void)bg;
+}
+
+void TFT_eSPI::setTextSize(uint8_t s)
+{
+  _textSize = s ? s : 1;
+}
+
+void TFT_eSPI::setCursor(int16_t x, int16_t y)
+{
+  _cursorX = x;
+  _cursorY = y;
+}
+
+size_t TFT_eSPI::write(const char *buf, size_t len)
+{
+  // Pas de rendu des glyphes : on compte les caractères et on avance le curseur
+  // (police GLCD 6x8 par caractère, multipliée par la taille de texte).
+  for (size_t i = 0; i < len; i++)
+  {
+    if (buf[i] == '\n')
+    {
+      _cursorX = 0;
+      _cursorY += 8 * _textSize;
+      continue;
+    }
+    _cursorX += 6 * _textSize;
+    _stats.textChars++;
+  }
+  return len;
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) const
+{
+  if (x < 0 || y < 0 || x >= _w || y >= _h)
+    return 0;
+  return _fb[(size_t)y * _w + x];
+}
+
+bool TFT_eSPI::savePpm(const char *path) const
+{
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+
+  fprintf(f, "P6\n%d %d\n255\n", _w, _h);
+  for (int32_t i = 0; i < (int32_t)_w * _h; i++)
+  {
+    uint16_t c = _fb[i];
+    uint8_t rgb[3] = {
+        (uint8_t)(((c >> 11) & 0x1F) << 3),
+        (uint8_t)(((c >> 5) & 0x3F) << 2),
+        (uint8_t)((c & 0x1F) << 3),
+    };
+    fwrite(rgb, 1, 3, f);
+  }
+
+  fclose(f);
+  return true;
+}
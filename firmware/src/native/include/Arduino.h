@@ -0,0 +1,100 @@
+#pragma once
+
+// Sous-ensemble de l'API Arduino pour la cible [env:native].
+// Juste ce que les services Espgotchi utilisent : temps, Serial, LEDC, GPIO.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+// Pas de flash séparée en natif : les tables PROGMEM sont de simples const
+#define PROGMEM
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+// -------- Temps --------
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// -------- GPIO / LEDC (sans effet en natif) --------
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+
+uint32_t ledcSetup(uint8_t chan, uint32_t freq, uint8_t bitNum);
+void ledcAttachPin(uint8_t pin, uint8_t chan);
+void ledcWrite(uint8_t chan, uint32_t duty);
+uint32_t ledcWriteTone(uint8_t chan, uint32_t freq);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// -------- Print / Serial --------
+class Print
+{
+public:
+  virtual ~Print() = default;
+
+  virtual size_t write(const char *buf, size_t len) = 0;
+
+  size_t print(const char *s) { return write(s, strlen(s)); }
+  size_t print(char c) { return write(&c, 1); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned int v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  // Comme sur Arduino : un uint8_t s'affiche en décimal
+  size_t print(unsigned char v) { return printf("%u", (unsigned)v); }
+
+  size_t println() { return write("\n", 1); }
+  template <typename T>
+  size_t println(T v)
+  {
+    size_t n = print(v);
+    return n + println();
+  }
+
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void flush();
+
+  // Pas de console en entrée en natif : aucune commande série
+  int available() { return 0; }
+  int read() { return -1; }
+
+  size_t write(const char *buf, size_t len) override;
+};
+
+extern HardwareSerial Serial;
+
+// -------- ESP (stats heap) --------
+class EspClass
+{
+public:
+  uint32_t getHeapSize() const;
+  uint32_t getFreeHeap() const;
+  uint32_t getMinFreeHeap() const;
+  uint32_t getMaxAllocHeap() const;
+  uint32_t getPsramSize() const { return 0; }
+  uint32_t getFreePsram() const { return 0; }
+};
+
+extern EspClass ESP;
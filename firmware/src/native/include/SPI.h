@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+#define VSPI 3
+#define HSPI 2
+
+// Bus SPI factice : le tactile natif ne passe pas par le matériel.
+class SPIClass
+{
+public:
+  explicit SPIClass(uint8_t bus) { (void)bus; }
+  void begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss)
+  {
+    (void)sck;
+    (void)miso;
+    (void)mosi;
+    (void)ss;
+  }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+// TFT_eSPI en natif : framebuffer RGB565 en mémoire + compteurs d'appels.
+// Les compteurs servent de proxy au coût SPI réel sur le CYD
+// (une primitive = une fenêtre d'adressage, un pixel = 2 octets poussés).
+
+#include <Arduino.h>
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+#define TFT_BLACK 0x0000
+#define TFT_DARKGREY 0x7BEF
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_GREEN 0x07E0
+#define TFT_WHITE 0xFFFF
+
+struct NativeTftStats
+{
+  uint32_t primitives = 0; // fillRect / drawRect / lignes / fillScreen / setAddrWindow
+  uint32_t pixels = 0;     // pixels effectivement écrits
+  uint32_t textChars = 0;  // caractères imprimés
+  uint32_t dmaPixels = 0;  // dont pixels poussés par DMA (pushPixelsDMA)
+};
+
+class TFT_eSPI : public Print
+{
+public:
+  TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+
+  void init();
+  void setRotation(uint8_t r);
+
+  int16_t width() const { return _w; }
+  int16_t height() const { return _h; }
+
+  void fillScreen(uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+
+  // Écriture en rafale : fenêtre d'adressage puis pixels en ordre raster
+  void startWrite() {}
+  void endWrite() {}
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+  void pushColor(uint16_t color, uint32_t len);
+  void pushColors(uint16_t *data, uint32_t len, bool swap = true);
+
+  // DMA : transfert synchrone en natif (dmaWait() n'attend jamais). Comme
+  // sur ESP32 avec setSwapBytes(false), le tampon est dans l'ordre du bus.
+  bool initDMA() { return true; }
+  void dmaWait() {}
+  void pushPixelsDMA(uint16_t *image, uint32_t len);
+
+  // Image w x h en une fenêtre + une rafale (ordre du bus, comme le DMA)
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+
+  void setTextColor(uint16_t fg, uint16_t bg);
+  void setTextSize(uint8_t s);
+  void setCursor(int16_t x, int16_t y);
+
+  size_t write(const char *buf, size_t len) override;
+
+  // --- Spécifique natif ---
+  const uint16_t *framebuffer() const { return _fb; }
+  uint16_t readPixel(int32_t x, int32_t y) const;
+  const NativeTftStats &stats() const { return _stats; }
+  void resetStats() { _stats = NativeTftStats(); }
+
+  // Écrit le framebuffer au format PPM (P6), pratique pour un diff visuel.
+  bool savePpm(const char *path) const;
+
+private:
+  int16_t _physW;
+  int16_t _physH;
+  int16_t _w;
+  int16_t _h;
+  uint16_t *_fb = nullptr;
+  NativeTftStats _stats;
+
+  // Fenêtre courante de setAddrWindow() et position d'écriture
+  int32_t _winX = 0, _winY = 0, _winW = 0, _winH = 0;
+  int32_t _curX = 0, _curY = 0;
+  void pushPixel(uint16_t color);
+
+  int16_t _cursorX = 0;
+  int16_t _cursorY = 0;
+  uint8_t _textSize = 1;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include "SPI.h"
+
+class TS_Point
+{
+public:
+  TS_Point() = default;
+  TS_Point(int16_t x, int16_t y, int16_t z) : x(x), y(y), z(z) {}
+
+  int16_t x = 0;
+  int16_t y = 0;
+  int16_t z = 0;
+};
+
+// Tactile natif : point brut (coordonnées XPT2046) piloté par le code hôte.
+// Par défaut, personne ne touche l'écran.
+struct NativeTouchState
+{
+  bool down = false;
+  TS_Point raw;
+};
+
+extern NativeTouchState g_nativeTouch;
+
+class XPT2046_Touchscreen
+{
+public:
+  XPT2046_Touchscreen(uint8_t cs, uint8_t irq)
+  {
+    (void)cs;
+    (void)irq;
+  }
+
+  bool begin(SPIClass &spi)
+  {
+    (void)spi;
+    return true;
+  }
+  void setRotation(uint8_t r) { (void)r; }
+
+  bool touched() { return g_nativeTouch.down; }
+  TS_Point getPoint() { return g_nativeTouch.raw; }
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+// heap_caps en natif : pas de PSRAM, tout part sur malloc().
+// heap_caps_malloc(MALLOC_CAP_SPIRAM) échoue, comme sur un ESP32 sans PSRAM.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,7 @@
+#pragma once
+
+// esp_rom_printf en natif : simple printf sur stdout.
+
+#include <stdio.h>
+
+#define esp_rom_printf printf
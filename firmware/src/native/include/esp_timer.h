@@ -0,0 +1,15 @@
+#pragma once
+
+// esp_timer en natif : horloge monotone Linux, en microsecondes.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif